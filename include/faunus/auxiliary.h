@@ -643,7 +643,7 @@ namespace Faunus
 
       Tcoeff &operator[]( const Tvec &v )
       {
-          return base::operator()(v[0], v[1]);
+          return base::operator()(int(v[0]), int(v[1]));
       }
 
       bool isInRange( const Tvec &v )
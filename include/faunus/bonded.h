@@ -48,7 +48,8 @@ namespace Faunus
      *
      * where the first filed specifies the two particle index; `k` (kT) and `req` (angstrom)
      * are the force constant and equilibrium distance, respectively. By default, the bond
-     * type is set to `HARMONIC`.
+     * type is set to `HARMONIC`. For `"type":"fene"`, `k` and `req` are instead the
+     * stiffness and maximum separation of `Potential::FENE`.
      */
     struct BondData : public BondedBase
     {
@@ -73,8 +74,9 @@ namespace Faunus
             k = it.value()["k"] | 0.0;
             req = it.value()["req"] | 0.0;
             string t = it.value()["type"] | string("harmonic");
-            if ( t == "harmonic" )
-                type = Type::HARMONIC;
+            type = Type::HARMONIC;
+            if ( t == "fene" )
+                type = Type::FENE;
         }
 
         /** @brief Write to stream */
@@ -2,6 +2,7 @@
 #define FAUNUS_ENERGY_H
 
 #include <unordered_map>
+#include <atomic>
 
 #ifndef SWIG
 #include <faunus/common.h>
@@ -14,6 +15,7 @@
 #include <faunus/auxiliary.h>
 #include <faunus/bonded.h>
 #include <faunus/multipole.h>
+#include <faunus/sasa.h>
 #include <Eigen/Eigenvalues>
 
 #endif
@@ -21,9 +23,6 @@
 #include <faunus/mpi.h>
 #endif
 
-#ifdef FAU_POWERSASA
-#include <power_sasa.h>
-#endif
 
 namespace Faunus
 {
@@ -136,7 +135,7 @@ namespace Faunus
         { return 0; }
 
         /* @brief Total energy of i'th = i2all+i_external+i_internal */
-        double i_total( Tpvec &p, int i ) { return i2all(p, i) + i_external(p, i) + i_internal(p, i); }
+        virtual double i_total( Tpvec &p, int i ) { return i2all(p, i) + i_external(p, i) + i_internal(p, i); }
 
         /* @brief Group to group */
         virtual double g2g( const Tpvec &, Group &, Group & )     // Group-Group energy
@@ -163,40 +162,110 @@ namespace Faunus
         /** @brief Update energy function due to Change */
         virtual double updateChange( const typename Tspace::Change &c ) { return 0; }
 
+        /**
+         * @brief Energy change when positions and container are scaled isotropically by `s`
+         *
+         * Used by volume moves to avoid recalculating the energy. All
+         * particle-particle distances must scale by `s`, i.e. groups are
+         * atomic or contain a single particle. The trial geometry is in
+         * `Space::geo_trial`.
+         *
+         * @returns NaN if the energy term cannot be scaled
+         */
+        virtual double scaleChange( double ) { return std::numeric_limits<double>::quiet_NaN(); }
+
         virtual void field( const Tpvec &, Eigen::MatrixXd & ) //!< Calculate electric field on all particles
         {}
 
+        /** @brief True if energy functions may be called concurrently, i.e. no internal state is updated */
+        virtual bool isReentrant() { return false; }
+
+        /**
+         * @brief Total energy of particle vector
+         *
+         * Groups are divided into blocks of `tile` groups and the energy of
+         * each pair of blocks -- on the diagonal including internal and
+         * external group energies -- is summed separately. Block sums are
+         * added in a fixed order so that the result is independent of the
+         * number of threads. With OpenMP, blocks are evaluated in parallel
+         * if there are many groups and `isReentrant()`; otherwise the group
+         * energy functions may themselves be parallel.
+         */
         virtual double systemEnergy( const Tpvec &p )
         {
-            double u_pair = 0.0;
-            double u = external(p);
-            for ( auto g : spc->groupList())
-                if (!g->empty())
-                    u += g_external(p, *g) + g_internal(p, *g);
-            for ( auto i = spc->groupList().begin(); i != spc->groupList().end(); ++i )
-                for ( auto j = i; ++j != spc->groupList().end(); )
-                    u_pair += g2g(p, **i, **j);
-            return u + u_pair;
+            const int tile = 16;
+            auto &g = spc->groupList();
+            int n = g.size(), m = (n + tile - 1) / tile; // number of groups and blocks
+            vector<std::pair<int, int>> blocks;
+            for ( int I = 0; I < m; I++ )
+                for ( int J = I; J < m; J++ )
+                    blocks.push_back({I, J});
+            vector<double> ublock(blocks.size(), 0);
+#ifdef _OPENMP
+            bool parallel = n > 2 * tile && isReentrant();
+#pragma omp parallel for schedule (dynamic) if (parallel)
+#endif
+            for ( int b = 0; b < (int) blocks.size(); b++ )
+            {
+                int I = blocks[b].first, J = blocks[b].second;
+                double u = 0;
+                for ( int i = I * tile; i < std::min(n, (I + 1) * tile); i++ )
+                {
+                    if ( I == J && !g[i]->empty())
+                        u += g_external(p, *g[i]) + g_internal(p, *g[i]);
+                    for ( int j = std::max(J * tile, i + 1); j < std::min(n, (J + 1) * tile); j++ )
+                        u += g2g(p, *g[i], *g[j]);
+                }
+                ublock[b] = u;
+            }
+            return external(p) + std::accumulate(ublock.begin(), ublock.end(), 0.0);
         }
 
-        virtual double g2All(const Tpvec & p, const std::map<int, vector<int>>& mg)
+        /**
+         * @brief Energy of moved groups with all other groups
+         *
+         * As in `systemEnergy()`, static groups are divided into blocks of
+         * `tile` groups and the block sums for each moved group are added in
+         * a fixed order. With OpenMP, blocks are evaluated in parallel if
+         * there are many groups and `isReentrant()`.
+         */
+        virtual double g2All(const Tpvec & p, const ChangeMap<vector<int>>& mg)
         {
-            double du = 0;
+            const int tile = 16;
             auto &g = spc->groupList();
-
-            for ( auto &m : mg ) // loop over all moved groups
+            int n = g.size(), m = (n + tile - 1) / tile; // number of groups and blocks
+            vector<int> moved;
+            for ( auto &k : mg )
+                moved.push_back(k.first);
+
+            // Calculate energy moved <-> static groups
+            vector<double> ublock(moved.size() * m, 0);
+            std::atomic<bool> rejected(false);
+#ifdef _OPENMP
+            bool parallel = n > 2 * tile && isReentrant();
+#pragma omp parallel for schedule (dynamic) if (parallel)
+#endif
+            for ( int b = 0; b < (int) ublock.size(); b++ )
             {
-                size_t i = size_t(m.first);                       // index of moved group
-
-                // Calculate energy moved <-> static groups
-                for ( size_t j = 0; j < g.size(); j++ ) {           // loop over through all groups
-                    if ( mg.count(j) == 0 ) {                // If group j is not in mvGroup
-                        du += g2g(p, *g[i], *g[j]);           // moved group<->static groups
-                        if ( du == pc::infty )
-                            return pc::infty;   // early rejection
+                if ( rejected )
+                    continue;
+                int i = moved[b / m], J = b % m;
+                double u = 0;
+                for ( int j = J * tile; j < std::min(n, (J + 1) * tile); j++ )
+                    if ( mg.count(j) == 0 )     // If group j is not in mvGroup
+                    {
+                        u += g2g(p, *g[i], *g[j]); // moved group<->static groups
+                        if ( u == pc::infty )
+                        {
+                            rejected = true;   // early rejection
+                            break;
+                        }
                     }
-                }
+                ublock[b] = u;
             }
+            if ( rejected )
+                return pc::infty;
+            double du = std::accumulate(ublock.begin(), ublock.end(), 0.0);
 
             // Calculate energy moved <-> moved
             for ( auto i = mg.begin(); i != mg.end(); i++ )
@@ -224,419 +293,350 @@ namespace Faunus
     };
 
     /**
-     *  \brief Energy matrix - allows acceleration of Metropolis algorithm up to 2x by storing pair-wise enegies
-     *  \param EType - set type for energy storage in energy matrix - e.g. double, float, half_float
+     * @brief Cache of group-group energies for fast Metropolis moves
+     *
+     * Stores the energy between all pairs of groups in `Space::groupList()`,
+     * the internal energy of molecular groups, and, for atomic groups
+     * (`Group::isAtomic()`), the energy of each particle with every other
+     * group. Energies of the current configuration are thus looked up
+     * rather than calculated, while trial energies are calculated only
+     * for pairs involving groups in `Change::mvGroup`. These are staged
+     * and written to the cache upon acceptance in `update(true)`.
      *
-     *  Usage:
+     * When a subset of an atomic group is moved, e.g. a single salt
+     * particle, the new group-group energies are obtained from the
+     * particle rows so that only the moved particles are evaluated. This
+     * allows systems mixing molecules and free salt to use the cache.
+     * Molecular groups, rigid or flexible, are re-evaluated as a whole
+     * against each partner when moved, as is their internal energy.
      *
-     * Energy::EnergyMatrix<double, Tspace, Energy::NonbondedCutg2g<Tspace,Tpairpot> > nonEM(mcp);
+     * Usage:
      *
-     * NOTE: Currently only works for rigid many-particle species, i.e. All groups of GroupList needs to be molecular.
+     *     Energy::EnergyMatrix<double, Tspace, Energy::NonbondedCutg2g<Tspace,Tpairpot> > nonEM(mcp);
      *
+     * `EType` is the storage type and `float` halves the memory use.
+     * To guard against drift from incremental updates and missed
+     * acceptances, the cache can be compared and resynchronised with a
+     * full recalculation every `ematrix_check` accepted updates, read
+     * from section `energy/nonbonded` (default: 0 = never). The largest
+     * deviation is shown in `info()`.
+     *
+     * @note For atomic groups the group-group energy must equal the sum
+     *       of `i2g()` over its particles, which holds for `Nonbonded`
+     *       and `NonbondedCutg2g`.
      */
     template<typename EType, class Tspace, class Base>
       class EnergyMatrix : public Base {
     private:
-        std::vector< std::vector<EType> > eMatrix;                 /// \brief Energy matrix, elements only valid for i > j indexes
-        std::vector< std::vector<EType> > eMatrix2;                /// \brief Energy matrix duplicate, useful for certain move(isobaric for example)
-        std::unordered_map<Group* , unsigned int> groupMap;   /// \brief Mapping unique_Group_ID==KEY to index in Energy matrix, groupMap[group.id] = index in eMatrix
-
         typedef Energy::Energybase<Tspace> SuperBase;
         typedef typename Tspace::ParticleType Tparticle;
         typedef typename Tspace::GeometryType Tgeometry;
         typedef typename Space<Tgeometry, Tparticle>::ParticleVector Tpvec;
+        typedef std::vector<std::pair<size_t, EType> > Tstaged;
 
         using SuperBase::spc;
         using SuperBase::isTrial;
 
-    public:
-        std::vector<double> changes;    /// \brief Temporarily stored changes to the Energy matrix generated in each trial configuration energy calculation
+        std::vector<EType> pairs;     // group-group energies, lower triangle
+        std::vector<EType> internal;  // internal energy of non-atomic groups
+        std::vector<EType> rows;      // particle-group energies for atomic groups
+        std::vector<int> rowIndex;    // particle index -> row in `rows` or -1
+        std::unordered_map<const Group*, int> groupMap; // group -> index in group list
+        Tstaged stagedPairs, stagedInternal, stagedRows; // trial energies awaiting acceptance
+
+        size_t ngroups = 0, nparticles = 0;
+        bool built = false;
+        int checkInterval, accepted = 0;
+        double drift = 0; // largest deviation found by `check()`
 
-        bool all = false;       /// \brief true signifies that we need to swap EMs
-        std::map<int, vector<int>> multi; /// \brief !empty() - signifies that we modified a series of particles and its interactions
-        int single = -1;        /// \brief true signifies that we modified a single particle and its interactions
+        static size_t tri( size_t i, size_t j )
+        {
+            if ( i < j )
+                std::swap(i, j);
+            return i * (i - 1) / 2 + j;
+        }
 
-        std::vector< std::vector<EType> >* energyMatrix;       /// \brief We are using eMatrix via a pointer for easy swapping
-        std::vector< std::vector<EType> >* energyMatrixTrial;
+        size_t row( int k, size_t j ) const { return size_t(rowIndex[k]) * ngroups + j; }
 
-        ///  The simulation starts by systemEnergy() call to set up for drift calculation, this used for EM initiation
-        ///
-        ///
-        ///  @Warning Mikael - This is potentialy problematic since the proper initiation of EM is depended on systemEnergy call outside of this class
-        ///                  - Maybe modify ufunction and add another Init function call to it
-        ///
-        ///
-        bool firstGlobal=true;  /// \brief Used to distinguish first systemEnergy method call for EM initiation
+        /** @brief True if cache matches current groups and particles */
+        bool valid() const
+        {
+            return built && ngroups == spc->groupList().size() && nparticles == spc->p.size();
+        }
 
         /**
-         * @brief EnergyMatrix - Constructor, allocates eMatrix and eMatrix2
+         * @brief Build cache if needed; false if `p` cannot be cached
+         *
+         * Trial energies are staged relative to the current configuration,
+         * which is used to build the cache if invalid.
          */
-        EnergyMatrix(Tmjson &j) : Base(j)
+        bool ready( const Tpvec &p )
         {
-            unsigned int size = 0;
-            energyMatrix = &eMatrix;
-            energyMatrixTrial = &eMatrix2;
-
-            try{
-                changes.reserve(1024 + size);
-
-                energyMatrix->resize( size ); // resize EMs so it has minimal space to properly store all i > j elements
-                for(unsigned int i=0; i < size; i++) {
-                    energyMatrix->operator [](i).resize( i );
-                }
-
-                energyMatrixTrial->resize( size );
-                for(unsigned int i=0; i < size; i++) {
-                    energyMatrixTrial->operator [](i).resize( i );
-                }
-            } catch(std::bad_alloc& bad) {
-                fprintf(stderr, "\nTOPOLOGY ERROR: Could not allocate memory for Energy matrix");
-                exit(1);
+            if ( isTrial(p) && spc->trial.size() != spc->p.size())
+            {
+                built = false;
+                return false;
             }
+            if ( !valid())
+                build();
+            return true;
         }
 
-        double g2g( const Tpvec &p, Group &g1, Group &g2 )
+        int index( const Group &g ) const
         {
-            if(isTrial(p)) {
-                return Base::g2g(p, g1, g2);
-            } else {
-                if( groupMap[&g1] > groupMap[&g2] )
-                    return (*energyMatrix)[groupMap[&g1]][groupMap[&g2]];
-                else
-                    return (*energyMatrix)[groupMap[&g2]][groupMap[&g1]];
-            }
+            auto it = groupMap.find(&g);
+            return (it == groupMap.end()) ? -1 : it->second;
         }
 
-        double g1g2( const Tpvec &p1, Group &g1, const Tpvec &p2, Group &g2 )
+        /** @brief Energy of all particles in atomic group `a` with group `b`; rows are staged */
+        double rowSum( const Tpvec &p, size_t a, size_t b )
         {
-            if(isTrial(p1) || isTrial(p2)) {
-                return Base::g1g2(p1, g1, p2, g2);
-            } else {
-                if( groupMap[&g1] > groupMap[&g2] )
-                    return (*energyMatrix)[groupMap[&g1]][groupMap[&g2]];
-                else
-                    return (*energyMatrix)[groupMap[&g2]][groupMap[&g1]];
-            }
-        }
-
-        double init( const Tpvec &p )
-        {
-            cout << "\n...Initiating Energy Matrix...\n" << endl;
-            double u = 0.0;
-
-            resizeEMatrix(spc->molTrack.size());
-            firstGlobal = false;
-
-            // initialize energy matrix
-            if(!energyMatrix->empty()) {
-                auto map = spc->molTrack.getMap();
-
-                initGroupMap();
-
-                //
-                // Equivalent of doing 2 for cycles:
-                //
-                //  for( i=1; i < size; ++i )
-                //      for( j=0; j < i; ++j )
-                //
-                //  4 particles -> 0, 1, 2, 3
-                //  Looping(i,j) : (1,0), (2,0), (2,1), (3,0), (3,1), (3,2)
-                //
-                unsigned int i=1, j=0;
-                for(auto tid_i = map.begin(); tid_i != map.end(); ++tid_i) { // loop over molecule types -> elements of map <KEY = TID, vector<GROUP*>>
-                    for(auto group_i = tid_i->second.begin(); group_i != tid_i->second.end(); ++group_i) { // loop over molecules of tid_i type -> elements of vector<GROUP*>
-                        if(tid_i == map.begin() && group_i == tid_i->second.begin()) // discart first particle due to i > j ordering
-                            ++group_i;
-
-                        for(auto tid_j = map.begin(); tid_j != map.end(); ++tid_j) { // loop over molecule types -> elements of map <KEY = TID, vector<GROUP*>>
-                            // loop over molecules of tid_j type -> elements of vector<GROUP*>, end when END of container or reached group_i
-                            for(auto group_j = tid_j->second.begin(); ( (group_j != tid_j->second.end()) && (group_j != group_i) ); ++group_j) {
-                                assert( i == groupMap[&(**group_i)] );
-                                assert( j == groupMap[&(**group_j)] );
-                                assert(i > j);
-                                (*energyMatrix)[i][j] = Base::g2g(p, **group_i, **group_j );
-                                u += (*energyMatrix)[i][j];
-                                ++j;
-                            }
-                        }
-                        j=0;
-                        ++i;
-                    }
-                }
+            double u = 0;
+            Group &ga = *spc->groupList()[a], &gb = *spc->groupList()[b];
+            for ( auto k : ga )
+            {
+                double e = Base::i2g(p, gb, k);
+                stagedRows.push_back({row(k, b), EType(e)});
+                u += e;
             }
             return u;
         }
 
         /**
-         * @brief systemEnergy - Calculate system energy on the basis on Groups
-         *
-         * This implementation assumes the order of groups in EnergyMatrix is identical to the one in GroupList
-         *
-         * @param p
-         * @return
+         * @brief Stage trial energy between groups `i` and `j`
+         * @param moved Moved particles in group `i`; empty if entire group or unknown
+         * @param partial True if only `moved` particles have changed and `j` is static
          */
-        double systemEnergy( const Tpvec &p ) override
+        double stagePair( const Tpvec &p, size_t i, const vector<int> &moved, size_t j, bool partial )
         {
-            double u_pair = 0.0;
-            double u = Base::external(p);
-            for ( auto g : spc->groupList())
-                u += Base::g_external(p, *g) + Base::g_internal(p, *g);
-
-            if(firstGlobal) {
-                return u + init(p);
-            }
-
-            if(isTrial(p)) {
-                all = true;
-                if(!energyMatrix->empty()) {
-                    auto map = spc->molTrack.getMap();
-
-                    unsigned int i=1, j=0;
-                    for(auto tid_i = map.begin(); tid_i != map.end(); ++tid_i) { // loop over molecule types -> elements of map <KEY = TID, vector<GROUP*>>
-                        for(auto group_i = tid_i->second.begin(); group_i != tid_i->second.end(); ++group_i) { // loop over molecules of tid_i type -> elements of vector<GROUP*>
-                            if(tid_i == map.begin() && group_i == tid_i->second.begin()) // discart first particle due to i > j ordering
-                                ++group_i;
-
-                            for(auto tid_j = map.begin(); tid_j != map.end(); ++tid_j) { // loop over molecule types -> elements of map <KEY = TID, vector<GROUP*>>
-                                // loop over molecules of tid_j type -> elements of vector<GROUP*>, end when END of container or reached group_i
-                                for(auto group_j = tid_j->second.begin(); ( (group_j != tid_j->second.end()) && (group_j != group_i) ); ++group_j) {
-                                    assert( i == groupMap[&(**group_i)] );
-                                    assert( j == groupMap[&(**group_j)] );
-                                    assert(i > j);
-                                    (*energyMatrix)[i][j] = Base::g2g(p, **group_i, **group_j );
-                                    u_pair += (*energyMatrix)[i][j];
-                                    ++j;
-                                }
-                            }
-                            j=0;
-                            ++i;
-                        }
-                    }
+            auto &g = spc->groupList();
+            Group &gi = *g[i], &gj = *g[j];
+            double u;
+            if ( partial && gi.isAtomic())
+            {
+                u = pairs[tri(i, j)];
+                for ( auto k : moved )
+                {
+                    double e = Base::i2g(p, gj, k);
+                    u += e - rows[row(k, j)];
+                    stagedRows.push_back({row(k, j), EType(e)});
                 }
-            } else {
-                // No need to translate through groupMap, sum all elements
-                assert(energyMatrix->size() == spc->molTrack.size());
-                if(!energyMatrix->empty()) {
-                    for ( unsigned int i = 1; i < energyMatrix->size(); ++i ) {
-                        for ( unsigned int j = 0; j < i; ++j ) {
-                            u_pair += (*energyMatrix)[i][j];
-                            assert( (*energyMatrix)[i][j] == g2g(p, *spc->groupList()[i], *spc->groupList()[j]) );
-                        }
+                if ( gj.isAtomic())
+                    for ( auto l : gj )
+                    {
+                        double e = rows[row(l, i)];
+                        for ( auto k : moved )
+                            e += Base::i2i(p, l, k) - Base::i2i(spc->p, l, k);
+                        stagedRows.push_back({row(l, i), EType(e)});
                     }
-                }
             }
-
-            assert(fabs( (u_pair+u) - Base::systemEnergy(p) ) < Base::systemEnergy(p)*1e-9 && "EM system energy significantly different from base");
-            return u + u_pair;
-        }
-
-        inline double update(bool acc) override {
-            if(acc) {
-                modify();
-            } else {
-                all = false;
-                single = -1;
-                multi.clear();
+            else if ( gi.isAtomic())
+            {
+                u = rowSum(p, i, j);
+                if ( gj.isAtomic())
+                    rowSum(p, j, i);
             }
-            return 0.0;
+            else if ( gj.isAtomic())
+                u = rowSum(p, j, i);
+            else
+                u = Base::g2g(p, gi, gj);
+            stagedPairs.push_back({tri(i, j), EType(u)});
+            return u;
         }
 
-        /**
-         * @brief g2All Calculate group to group energies between groups of mg (moved groups) and rest of groups
-         *
-         * This implementation assumes the order of groups in EnergyMatrix is identical to the one in GroupList
-         *
-         * @param p
-         * @param mg
-         * @return
-         */
-        double g2All(const Tpvec & p, const std::map<int, vector<int>>& mg) override
+        double stageInternal( const Tpvec &p, size_t i )
         {
-            double du = 0;
-            auto &g = spc->groupList();
-            int count = 0;
+            double u = Base::g_internal(p, *spc->groupList()[i]);
+            stagedInternal.push_back({i, EType(u)});
+            return u;
+        }
 
-            if(isTrial(p)) {
-                changes.resize(g.size() * mg.size());
-                multi = std::map<int, vector<int>>(mg);
+        void clearStaged()
+        {
+            stagedPairs.clear();
+            stagedInternal.clear();
+            stagedRows.clear();
+        }
 
-                for ( auto &m : mg ) // loop over all moved groups
-                {
-                    size_t i = size_t(m.first);                       // index of moved group
-                    assert(g[i]->isMolecular());
-
-                    // Calculate energy moved <-> static groups
-                    for ( size_t j = 0; j < g.size(); j++ ) {           // loop over through all groups
-                        if ( mg.count(j) == 0 ) {                // If group j is not in mvGroup
-                            changes[count] = g2g(p, *g[i], *g[j]);
-                            du += changes[count];           // moved group<->static groups
-                            ++count;
-                            if ( du == pc::infty )
-                                return pc::infty;   // early rejection
-                        }
-                    }
-                }
+        void commit()
+        {
+            for ( auto &s : stagedPairs )
+                pairs[s.first] = s.second;
+            for ( auto &s : stagedInternal )
+                internal[s.first] = s.second;
+            for ( auto &s : stagedRows )
+                rows[s.first] = s.second;
+            clearStaged();
+        }
 
-                // Calculate energy moved <-> moved
-                for ( auto i = mg.begin(); i != mg.end(); i++ )
-                {
-                    for ( auto j = (++mg.begin()); j != mg.end(); j++ )
-                    {
-                        auto _i = i->first;
-                        auto _j = j->first;
-                        changes[count] = g2g(p, *g[_i], *g[_j]);
-                        du += changes[count];
-                        ++count;
-                        if ( du == pc::infty )
-                            return pc::infty;   // early rejection
-                    }
-                }
-            } else {
-                for ( auto &m : mg ) {
-                    for ( auto &m : mg ) {
-                        size_t i = size_t(m.first);
-                        assert(g[i]->isMolecular());
-
-                        for ( size_t j = 0; j < g.size(); j++ ) {
-                            if ( mg.count(j) == 0 ) {
-                                if(i > j) {
-                                    du += (*energyMatrix)[i][j];
-                                } else {
-                                    du += (*energyMatrix)[j][i];
-                                }
-                            }
-                        }
-                    }
-                    for ( auto i = mg.begin(); i != mg.end(); i++ )
-                    {
-                        for ( auto j = (++mg.begin()); j != mg.end(); j++ ) // Can't use energy matrix for calculation of internal energy (j = i as in the rest of energy implementation)
-                        {
-                            auto _i = i->first;
-                            auto _j = j->first;
-                            if(_i > _j) {
-                                du += (*energyMatrix)[_i][_j];
-                            }
-                            else {
-                                du += (*energyMatrix)[_j][_i];
-                            }
-                        }
-                    }
-                }
+        /** @brief Fill cache from current configuration */
+        void build()
+        {
+            auto &g = spc->groupList();
+            ngroups = g.size();
+            nparticles = spc->p.size();
+            groupMap.clear();
+            for ( size_t i = 0; i < ngroups; i++ )
+                groupMap[g[i]] = i;
+
+            int n = 0;
+            rowIndex.assign(nparticles, -1);
+            for ( auto gi : g )
+                if ( gi->isAtomic())
+                    for ( auto k : *gi )
+                        rowIndex[k] = n++;
+
+            pairs.assign(ngroups * (ngroups - 1) / 2 + 1, 0);
+            internal.assign(ngroups, 0);
+            rows.assign(n * ngroups, 0);
+            clearStaged();
+            for ( size_t i = 0; i < ngroups; i++ )
+            {
+                if ( !g[i]->isAtomic())
+                    stageInternal(spc->p, i);
+                for ( size_t j = 0; j < i; j++ )
+                    stagePair(spc->p, i, vector<int>(), j, false);
             }
-            return du;
+            commit();
+            built = true;
         }
 
-        void resizeEMatrix(unsigned int size) {
-            assert(size >= 0);
+        /** @brief Compare with full recalculation and resynchronise */
+        void check()
+        {
+            std::vector<EType> p0 = pairs, i0 = internal;
+            build();
+            for ( size_t k = 0; k < pairs.size(); k++ )
+                drift = std::max(drift, std::fabs(double(pairs[k]) - double(p0[k])));
+            for ( size_t k = 0; k < internal.size(); k++ )
+                drift = std::max(drift, std::fabs(double(internal[k]) - double(i0[k])));
+        }
 
-            energyMatrix->resize(size);
-            for(unsigned int i=0; i < size; i++) {
-                energyMatrix->at(i).resize( i );
-            }
+        string _info() override
+        {
+            using namespace textio;
+            std::ostringstream o;
+            o << Base::_info()
+              << pad(SUB, 25, "Energy matrix") << ngroups << "x" << ngroups
+              << " (" << sizeof(EType) << " byte elements, "
+              << rows.size() / std::max(ngroups, size_t(1)) << " particle rows)\n";
+            if ( checkInterval > 0 )
+                o << pad(SUB, 25, "Matrix check interval") << checkInterval << "\n"
+                  << pad(SUB, 25, "Matrix max deviation") << drift << kT << "\n";
+            return o.str();
+        }
 
-            energyMatrixTrial->resize(size);
-            for(unsigned int i=0; i < size; i++) {
-                energyMatrixTrial->at(i).resize( i );
-            }
+    public:
+        EnergyMatrix( Tmjson &j ) : Base(j)
+        {
+            checkInterval = j["energy"]["nonbonded"]["ematrix_check"] | 0;
         }
 
-        inline void modify() {
-            if(!multi.empty()) {
-                fixEMatrixMulti(multi);
-                multi.clear();
-                return;
-            }
-            if(single != -1) {
-                fixEMatrixSingle(single);
-                single = -1;
-                return;
-            }
-            if(all) {
-                std::swap(energyMatrix, energyMatrixTrial);
-                all = false;
-                return;
-            }
-            std::cout << "EnergyMatrix::Modify() Error, move not recorded" << std::endl;
+        void setSpace( Tspace &s ) override
+        {
+            if ( &s != spc )
+                built = false;
+            Base::setSpace(s);
         }
 
-    private:
-        /**
-         * @brief initGroupMap - Initialize groupMap
-         *
-         * Take the adress of a Group (&Group) and map its position in GroupList
-         *
-         * SystemEnergy and g2All functions depends on the right ordering of Group in groupMap
-         *
-         * e.g. First group mapped to 0, second to 1, ...
-         */
-        void initGroupMap()
-        {
-            auto map = spc->molTrack.getMap();
-            int i=0;
-            for(auto g = map.begin(); g != map.end(); ++g) { // initiate mapping
-                for(auto gg = g->second.begin(); gg != g->second.end(); ++gg) {
-                    groupMap.insert( std::make_pair(&(**gg), i) );
-                    ++i;
-                }
-            }
+        double g2g( const Tpvec &p, Group &g1, Group &g2 ) override
+        {
+            if ( !ready(p))
+                return Base::g2g(p, g1, g2);
+            int i = index(g1), j = index(g2);
+            if ( i < 0 || j < 0 || i == j )
+                return Base::g2g(p, g1, g2);
+            if ( isTrial(p))
+                return stagePair(p, i, vector<int>(), j, false);
+            return pairs[tri(i, j)];
         }
 
-        void show() {
-            std::cout << "Energy matrix: " << std::endl;
-            for(unsigned int i=1; i<energyMatrix->size(); ++i) {
-                for(unsigned int j=0; j<i; ++j)
-                    std::cout << std::setw(7) << std::setprecision(4) << (*energyMatrix)[i][j] << " ";
-                std::cout << std::endl;
-            }
+        double g1g2( const Tpvec &p1, Group &g1, const Tpvec &p2, Group &g2 ) override
+        {
+            if ( &p1 == &spc->p && &p2 == &spc->p )
+                return g2g(p1, g1, g2);
+            return Base::g1g2(p1, g1, p2, g2);
         }
 
-        /**
-         * @brief fixEMatrixSingle - fix interaction energies when moving a single particle/molecule in Energy matrix
-         * @param target - id of element whose inteactions changed
-         */
-        void fixEMatrixSingle(unsigned int target) {
-            assert(changes.size() == energyMatrix->size());
-            for(unsigned int i=0; i < target; i++) {
-                energyMatrix->operator [](target)[i] = changes[i];
-            }
-            for(unsigned int i=target+1; i < energyMatrix->size(); i++) {
-                energyMatrix->operator [](i)[target] = changes[i];
-            }
+        double g_internal( const Tpvec &p, Group &g ) override
+        {
+            if ( !ready(p))
+                return Base::g_internal(p, g);
+            int i = index(g);
+            if ( i < 0 || g.isAtomic())
+                return Base::g_internal(p, g);
+            if ( isTrial(p))
+                return stageInternal(p, i);
+            return internal[i];
+        }
+
+        double systemEnergy( const Tpvec &p ) override
+        {
+            double u = Base::external(p);
+            for ( auto g : spc->groupList())
+                if ( !g->empty())
+                    u += Base::g_external(p, *g) + g_internal(p, *g);
+            auto &g = spc->groupList();
+            for ( size_t i = 0; i < g.size(); i++ )
+                for ( size_t j = i + 1; j < g.size(); j++ )
+                    u += g2g(p, *g[i], *g[j]);
+            return u;
         }
 
+        bool isReentrant() override { return false; } // cache is built and staged on demand
+
         /**
-         * @brief fixEMatrixMultin - fix interaction energies when moving a multiple particles/groups in Energy matrix
+         * @brief Energy between moved groups and all other groups
+         *
+         * For the current configuration this is a sum over cached elements
+         * while for the trial configuration only pairs involving moved
+         * groups are evaluated.
          */
-        void fixEMatrixMulti(std::map<int, vector<int>>& multi) {
+        double g2All( const Tpvec &p, const ChangeMap<vector<int>> &mg ) override
+        {
+            if ( !ready(p))
+                return Base::g2All(p, mg);
             auto &g = spc->groupList();
-            int count = 0;
-            for ( auto &m : multi )
+            double du = 0;
+            for ( auto &m : mg )
             {
                 size_t i = size_t(m.first);
-                for ( size_t j = 0; j < g.size(); j++ ) {
-                    if ( multi.count(j) == 0 ) {
-                        if(i > j)
-                            (*energyMatrix)[i][j] = changes[count];
-                        else
-                            (*energyMatrix)[j][i] = changes[count];
-                        ++count;
+                bool partial = !m.second.empty() && int(m.second.size()) < g[i]->size();
+                for ( size_t j = 0; j < g.size(); j++ )
+                    if ( j != i && mg.count(j) == 0 )
+                    {
+                        du += isTrial(p) ? stagePair(p, i, m.second, j, partial) : pairs[tri(i, j)];
+                        if ( du == pc::infty )
+                            return pc::infty; // early rejection
                     }
-                }
             }
-
-            for ( auto i = multi.begin(); i != multi.end(); i++ )
-            {
-                for ( auto j = (++multi.begin()); j != multi.end(); j++ )
+            for ( auto a = mg.begin(); a != mg.end(); ++a )
+                for ( auto b = std::next(a); b != mg.end(); ++b )
                 {
-                    auto _i = i->first;
-                    auto _j = j->first;
-                    if(_i > _j)
-                        (*energyMatrix)[_i][_j] = changes[count];
-                    else
-                        (*energyMatrix)[_j][_i] = changes[count];
-                    ++count;
+                    size_t i = size_t(a->first), j = size_t(b->first);
+                    du += isTrial(p) ? stagePair(p, i, a->second, j, false) : pairs[tri(i, j)];
+                    if ( du == pc::infty )
+                        return pc::infty;
                 }
+            return du;
+        }
+
+        double update( bool acc ) override
+        {
+            bool staged = !stagedPairs.empty() || !stagedInternal.empty() || !stagedRows.empty();
+            if ( acc && valid() && staged )
+            {
+                commit();
+                if ( checkInterval > 0 && ++accepted % checkInterval == 0 )
+                    check();
+            }
+            else
+            {
+                clearStaged();
+                if ( acc )
+                    built = false; // unknown change, e.g. by a move not using g2All(); rebuild when needed
             }
+            return Base::update(acc);
         }
     };
 
@@ -729,6 +729,10 @@ namespace Faunus
             return first.updateChange(c) + second.updateChange(c);
         }
 
+        double scaleChange( double s ) override { return first.scaleChange(s) + second.scaleChange(s); }
+
+        bool isReentrant() override { return first.isReentrant() && second.isReentrant(); }
+
         double v2v( const Tpvec &p1, const Tpvec &p2 ) override { return first.v2v(p1, p2) + second.v2v(p1, p2); }
 
         void field( const Tpvec &p, Eigen::MatrixXd &E ) override
@@ -789,6 +793,97 @@ namespace Faunus
         typedef typename Tbase::Tparticle Tparticle;
         typedef typename Tbase::Tpvec Tpvec;
 
+        /** @brief Structure-of-arrays mirror of `p` if enabled in Space, otherwise `nullptr` */
+        const ParticleArrays *arraysOf( const Tpvec &p ) const
+        {
+            if ( Tbase::spc != nullptr && Tbase::spc->hasArrays())
+                if ( &p == &Tbase::spc->p || &p == &Tbase::spc->trial )
+                {
+                    const ParticleArrays &soa = Tbase::spc->arrays(p);
+                    if ( soa.size() == p.size())
+                        return &soa;
+                }
+            return nullptr;
+        }
+
+        /**
+         * @brief Adds energy between `a` and particles `[first,last)` to `u`
+         *
+         * Dispatches to the batched kernel if `Potential::is_batched<Tpairpot>`,
+         * otherwise pairs are evaluated one at a time. If the space keeps
+         * `ParticleArrays`, distances are calculated in a single pass over
+         * the coordinate arrays and partner properties are read directly
+         * from these.
+         */
+        void i2range( const Tpvec &p, const Tparticle &a, int first, int last, double &u )
+        {
+            i2range(p, a, first, last, u, Potential::is_batched<Tpairpot>());
+        }
+
+        /**
+         * @brief Sum of `row(i)` for `i` in `[first,last)`
+         *
+         * Rows are added in order so that the result is identical with and
+         * without threads. With OpenMP, rows are evaluated in parallel if the
+         * total number of pairs, `pairs`, is large.
+         */
+        template<class Trow>
+        double rowSum( int first, int last, double pairs, Trow row )
+        {
+            double u = 0;
+            if ( pairs < 4096 )
+                for ( int i = first; i < last; ++i )
+                    u += row(i);
+            else
+            {
+                vector<double> r(std::max(0, last - first));
+#pragma omp parallel for schedule (dynamic, 8)
+                for ( int i = first; i < last; ++i )
+                    r[i - first] = row(i);
+                for ( auto ui : r )
+                    u += ui;
+            }
+            return u;
+        }
+
+        void i2range( const Tpvec &p, const Tparticle &a, int first, int last, double &u, std::false_type )
+        {
+            for ( int j = first; j < last; ++j )
+                u += pairpot(a, p[j], geo.sqdist(a, p[j]));
+        }
+
+        void i2range( const Tpvec &p, const Tparticle &a, int first, int last, double &u, std::true_type )
+        {
+            const int capacity = Potential::PairBlock::capacity;
+            double r2[capacity], charge[capacity], radius[capacity], ublock[capacity];
+            int id[capacity];
+            Potential::PairBlock block = {r2, charge, radius, id, 0};
+            const ParticleArrays *soa = arraysOf(p);
+            for ( int j = first; j < last; j += capacity )
+            {
+                block.size = std::min(capacity, last - j);
+                if ( soa != nullptr )
+                {
+                    Geometry::sqdist(geo, a, soa->x.data() + j, soa->y.data() + j, soa->z.data() + j, block.size, r2);
+                    block.charge = soa->charge.data() + j;
+                    block.radius = soa->radius.data() + j;
+                    block.id = soa->id.data() + j;
+                }
+                else
+                    for ( int k = 0; k < block.size; ++k )
+                    {
+                        const Tparticle &b = p[j + k];
+                        r2[k] = geo.sqdist(a, b);
+                        charge[k] = b.charge;
+                        radius[k] = b.radius;
+                        id[k] = b.id;
+                    }
+                pairpot.batch(a, block, ublock);
+                for ( int k = 0; k < block.size; ++k )
+                    u += ublock[k];
+            }
+        }
+
     public:
         typename Tspace::GeometryType geo;
         Tpairpot pairpot;
@@ -868,11 +963,16 @@ namespace Faunus
         {
             assert(i >= 0 && i < int(p.size()) && "index i outside particle vector");
             double u = 0;
-            int n = (int) p.size();
-            for ( int j = 0; j != i; ++j )
-                u += pairpot(p[i], p[j], geo.sqdist(p[i], p[j]));
-            for ( int j = i + 1; j < n; ++j )
-                u += pairpot(p[i], p[j], geo.sqdist(p[i], p[j]));
+            i2range(p, p[i], 0, i, u);
+            i2range(p, p[i], i + 1, (int) p.size(), u);
+            return u;
+        }
+
+        /** @brief Energy between particle `i` and particles `[first,last)` */
+        double i2range( const Tpvec &p, int i, int first, int last )
+        {
+            double u = 0;
+            i2range(p, p[i], first, last, u);
             return u;
         }
 
@@ -888,11 +988,9 @@ namespace Faunus
                         {  // g2 is a subgroup of g1
                             assert(g1.size() >= g2.size());
                             for ( int i = g1.front(); i < g2.front(); i++ )
-                                for ( auto j : g2 )
-                                    u += pairpot(p[i], p[j], geo.sqdist(p[i], p[j]));
+                                i2range(p, p[i], g2.front(), g2.back() + 1, u);
                             for ( int i = g2.back() + 1; i <= g1.back(); i++ )
-                                for ( auto j : g2 )
-                                    u += pairpot(p[i], p[j], geo.sqdist(p[i], p[j]));
+                                i2range(p, p[i], g2.front(), g2.back() + 1, u);
                             return u;
                         }
                     if ( g2.find(g1.front()))
@@ -900,20 +998,19 @@ namespace Faunus
                         {  // g1 is a subgroup of g2
                             assert(g2.size() >= g1.size());
                             for ( int i = g2.front(); i < g1.front(); i++ )
-                                for ( auto j : g1 )
-                                    u += pairpot(p[i], p[j], geo.sqdist(p[i], p[j]));
+                                i2range(p, p[i], g1.front(), g1.back() + 1, u);
                             for ( int i = g1.back() + 1; i <= g2.back(); i++ )
-                                for ( auto j : g1 )
-                                    u += pairpot(p[i], p[j], geo.sqdist(p[i], p[j]));
+                                i2range(p, p[i], g1.front(), g1.back() + 1, u);
                             return u;
                         }
 
                     // IN CASE BOTH GROUPS ARE INDEPENDENT (DEFAULT)
-                    int ilen = g1.back() + 1, jlen = g2.back() + 1;
-#pragma omp parallel for reduction (+:u)
-                    for ( int i = g1.front(); i < ilen; ++i )
-                        for ( int j = g2.front(); j < jlen; ++j )
-                            u += pairpot(p[i], p[j], geo.sqdist(p[i], p[j]));
+                    int jfirst = g2.front(), jlen = g2.back() + 1;
+                    u = rowSum(g1.front(), g1.back() + 1, double(g1.size()) * g2.size(), [&]( int i ) {
+                        double ui = 0;
+                        i2range(p, p[i], jfirst, jlen, ui);
+                        return ui;
+                    });
                 }
             return u;
         }
@@ -933,13 +1030,18 @@ namespace Faunus
             double u = 0;
             int b = g.back(), f = g.front();
             if ( !g.empty())
-                for ( int i = f; i < b; ++i )
-                    for ( int j = i + 1; j <= b; ++j )
-                        u += pairpot(p[i], p[j], geo.sqdist(p[i], p[j]));
+                u = rowSum(f, b, 0.5 * g.size() * g.size(), [&]( int i ) {
+                    double ui = 0;
+                    i2range(p, p[i], i + 1, b + 1, ui);
+                    return ui;
+                });
 	    u += pairpot.internal(p,g);
             return u;
         }
 
+        /** @brief Pair energies have no state; derived classes with caches must override */
+        bool isReentrant() override { return true; }
+
         double v2v( const Tpvec &p1, const Tpvec &p2 ) override
         {
             double u = 0;
@@ -950,22 +1052,129 @@ namespace Faunus
         }
     };
 
-/**
-     * @brief Energy class for non-bonded interactions that excludes bonded pairs.
-     *
-     * `Tpairpot` is expected to be a pair potential with the following
-     * properties:
+    /**
+     * @brief Nonbonded interactions decomposed into homogeneous terms for fast volume moves
      *
-     * - `Tpairpot(const Tmjson&)`
-     * - `double Tpairpot::operator()(const particle&, const particle&, double sqdist))`
+     * For pair potentials in `Potential::homogeneous`, e.g. `LennardJones`
+     * (r^-12 and r^-6) and `Coulomb` (r^-1), the total energy of each term
+     * is kept for the accepted configuration. Upon isotropic scaling of all
+     * distances by `s`, term `k` scales by @f$ s^{-n_k} @f$ so that the energy
+     * change of a volume move is obtained from `scaleChange()` without visiting
+     * any pairs.
      *
-     * For a list of implemented potentials, see the `Faunus::Potential`
-     * namespace.
+     * The sums are calculated when first needed and scaled when a volume move
+     * is accepted. Any other accepted move invalidates them, whereby the next
+     * volume move recalculates them once. Other energy functions are those of
+     * `Nonbonded`.
      */
-    template<class Tspace, class Tpairpot, typename base=Nonbonded<Tspace, Tpairpot>>
-    class NonbondedExcl : public base
+    template<class Tspace, class Tpairpot>
+    class NonbondedHomogeneous : public Nonbonded<Tspace, Tpairpot>
     {
-    protected:
+    private:
+        typedef Nonbonded<Tspace, Tpairpot> base;
+        typedef Potential::homogeneous<Tpairpot> Tterms;
+        using base::geo;
+        using base::pairpot;
+
+        vector<double> sum;  // energy of each term in accepted configuration
+        size_t n;            // number of particles when summed
+        bool valid;          // true if `sum` is up-to-date
+        double pending;      // scaling factor of last `scaleChange()`; zero if none
+        unsigned int cnt;    // number of times sums were calculated
+
+        string _info() override
+        {
+            using namespace textio;
+            std::ostringstream o;
+            o << base::_info() << pad(SUB, 25, "Homogeneous exponents");
+            for ( int k = 0; k < Tterms::size; k++ )
+                o << " -" << Tterms::exponent(k);
+            o << endl << pad(SUB, 25, "Term summations") << cnt << endl;
+            return o.str();
+        }
+
+        void calcSums()
+        {
+            auto &p = base::spc->p;
+            sum.assign(Tterms::size, 0);
+            for ( size_t i = 0; i < p.size(); i++ )
+                for ( size_t j = i + 1; j < p.size(); j++ )
+                    pairpot.terms(p[i], p[j], geo.sqdist(p[i], p[j]), sum.data());
+            n = p.size();
+            valid = true;
+            cnt++;
+        }
+
+    public:
+        NonbondedHomogeneous( Tmjson &j, const string &sec = "nonbonded" ) :
+            base(j, sec), n(0), valid(false), pending(0), cnt(0)
+        {
+            static_assert(Tterms::size > 0, "Tpairpot must be homogeneous (Potential::homogeneous)");
+            base::name += " (homogeneous)";
+        }
+
+        auto tuple() -> decltype(std::make_tuple(this))
+        {
+            return std::make_tuple(this);
+        }
+
+        /** @brief Energy of each homogeneous term in accepted configuration (kT) */
+        const vector<double> &terms()
+        {
+            if ( !valid || n != base::spc->p.size())
+                calcSums();
+            return sum;
+        }
+
+        bool isReentrant() override { return false; } // sums are calculated on demand
+
+        double scaleChange( double s ) override
+        {
+            double du = 0;
+            auto &u = terms();
+            for ( int k = 0; k < Tterms::size; k++ )
+                du += u[k] * (std::pow(s, -Tterms::exponent(k)) - 1);
+            pending = s;
+            return du;
+        }
+
+        double updateChange( const typename Tspace::Change &c ) override
+        {
+            pending = 0; // new move
+            return base::updateChange(c);
+        }
+
+        double update( bool acc ) override
+        {
+            if ( acc )
+            {
+                if ( pending > 0 && valid )
+                    for ( int k = 0; k < Tterms::size; k++ )
+                        sum[k] *= std::pow(pending, -Tterms::exponent(k));
+                else
+                    valid = false; // unknown change
+            }
+            pending = 0;
+            return base::update(acc);
+        }
+    };
+
+/**
+     * @brief Energy class for non-bonded interactions that excludes bonded pairs.
+     *
+     * `Tpairpot` is expected to be a pair potential with the following
+     * properties:
+     *
+     * - `Tpairpot(const Tmjson&)`
+     * - `double Tpairpot::operator()(const particle&, const particle&, double sqdist))`
+     *
+     * For a list of implemented potentials, see the `Faunus::Potential`
+     * namespace.
+     */
+    template<class Tspace, class Tpairpot, typename base=Nonbonded<Tspace, Tpairpot>>
+    class NonbondedExcl : public base
+    {
+    protected:
         Table<int> excl;
         using typename base::Tpvec;
         using typename base::Tparticle;
@@ -1495,6 +1704,366 @@ namespace Faunus
         }
     };
 
+/**
+     * @brief Nonbonded interactions using a cell list for cut-off based pair potentials
+     *
+     * A linked-cell grid (`Geometry::CellList`) over the accepted particle
+     * vector, `Space::p`, is used to visit only pairs within the pair potential
+     * cutoff in `i2all`, `g2g`, `g2All`, and `g_internal`. The grid is rebuilt
+     * on demand and moved particles are re-binned when moves are accepted,
+     * i.e. in `update(true)`. This is a general alternative to the mass center
+     * cutoff in `NonbondedCutg2g` and requires a rectangular box (`Cuboid`,
+     * `Cuboidslit`).
+     *
+     * Energies of the trial vector, `Space::trial`, use the grid together with
+     * the moved particles reported through `updateChange()`. If these are
+     * unknown, or if the geometry or number of particles change, the plain
+     * N-squared loops of `Nonbonded` are used instead.
+     *
+     * Optionally, `i2all` of the accepted vector is cached per particle
+     * together with the part from particles in other groups. When a single
+     * group is moved, `g2All` of the accepted vector is then a sum over the
+     * cache and, for the trial vector, only moved particles visit their
+     * neighbors, e.g. for the old and new configuration of single particle
+     * moves in `energyChange()`. When a move is accepted, cached energies
+     * of particles in cells surrounding the old and new positions of moved
+     * particles are invalidated.
+     *
+     * Upon construction the `Tmjson` is searched for the following in
+     * section `energy/nonbonded/`:
+     *
+     * Keyword        |  Description
+     * :------------- |  :------------------------------------
+     * `cutoff_p2p`   |  Pair potential cutoff (angstrom) [default: from `PairPotentialBase::rcut2`]
+     * `energy_cache` |  Cache particle energies, `i2all` [default: false]
+     *
+     * @warning The pair potential must be zero beyond the cutoff.
+     */
+    template<class Tspace, class Tpairpot>
+    class NonbondedCellList : public Energy::Nonbonded<Tspace, Tpairpot>
+    {
+    private:
+        typedef Energy::Nonbonded<Tspace, Tpairpot> base;
+        using typename base::Tpvec;
+        using base::pairpot;
+        using base::geo;
+
+        double rc;                  // pair cutoff
+        bool gridValid;             // grid and group index reflect spc->p
+        bool changeKnown;           // moved particles in trial vector are known
+        Geometry::CellList grid;    // cell list of spc->p
+        vector<int> groupOf;        // group index of each particle
+        vector<char> moved;         // moved particles in trial vector (flag)
+        vector<int> movedList;      // moved particles in trial vector (index)
+        vector<Point> movedFrom;    // positions in spc->p of `movedList` before move
+
+        bool useCache;              // cache i2all of spc->p
+        vector<double> ucache;      // i2all of spc->p (valid if `fresh`)
+        vector<double> uother;      // part of `ucache` from particles in other groups
+        vector<char> fresh;
+        unsigned long hits = 0, lookups = 0;
+
+        string _info() override
+        {
+            using namespace textio;
+            std::ostringstream o;
+            o << base::_info()
+              << pad(SUB, 25, "Cell list cutoff") << rc << _angstrom << endl;
+            if ( gridValid )
+                o << pad(SUB, 25, "Number of cells") << grid.numCells() << endl;
+            if ( useCache && lookups > 0 )
+                o << pad(SUB, 25, "Energy cache hits") << 100.0 * hits / lookups << percent << endl;
+            return o.str();
+        }
+
+        void rebuild()
+        {
+            auto &p = base::spc->p;
+            grid.setup(base::spc->geo.len, rc);
+            grid.build(p);
+            groupOf.assign(p.size(), -1);
+            auto &g = base::spc->groupList();
+            for ( size_t k = 0; k < g.size(); k++ )
+                for ( auto i : *g[k] )
+                    groupOf[i] = int(k);
+            moved.assign(p.size(), 0);
+            movedList.clear();
+            movedFrom.clear();
+            ucache.resize(p.size());
+            uother.resize(p.size());
+            fresh.assign(p.size(), 0);
+            changeKnown = false;
+            gridValid = true;
+        }
+
+        /** @brief Determines if the cell list can be used for particle vector */
+        bool useGrid( const Tpvec &p )
+        {
+            if ( base::spc == nullptr || rc >= pc::infty )
+                return false;
+            if ( &p != &base::spc->p )
+                if ( !base::isTrial(p) || !changeKnown )
+                    return false;
+            if ( !gridValid || grid.size() != base::spc->p.size()
+                || grid.boxLength() != base::spc->geo.len )
+                rebuild();
+            return true;
+        }
+
+        /** @brief Call `f(j)` for all particles, `j`, in cells surrounding `a` */
+        template<class Tfunc>
+        void neighbors( const Tpvec &p, const Point &a, Tfunc f ) const
+        {
+            if ( &p == &base::spc->p )
+                grid.forEachNeighbor(a, f);
+            else
+            {   // trial vector: binned positions are valid for unmoved particles only
+                grid.forEachNeighbor(a, [&]( int j ) { if ( !moved[j] ) f(j); });
+                for ( auto j : movedList )
+                    f(j);
+            }
+        }
+
+        inline double pairEnergy( const Tpvec &p, int i, int j ) const
+        {
+            double r2 = geo.sqdist(p[i], p[j]);
+            return (r2 < rc * rc) ? pairpot(p[i], p[j], r2) : 0;
+        }
+
+        /** @brief Look up or evaluate cached energy of particle `i` in `spc->p` */
+        void lookup( int i )
+        {
+            lookups++;
+            if ( fresh[i] )
+            {
+                hits++;
+                return;
+            }
+            auto &p = base::spc->p;
+            double u = 0, uo = 0;
+            neighbors(p, p[i], [&]( int j ) {
+                if ( j != i )
+                {
+                    double e = pairEnergy(p, i, j);
+                    u += e;
+                    if ( groupOf[j] >= 0 && groupOf[j] != groupOf[i] )
+                        uo += e;
+                }
+            });
+            ucache[i] = u;
+            uother[i] = uo;
+            fresh[i] = 1;
+        }
+
+        /** @brief Energy of all pairs, `i` in `g1` and `j` in `g2` but not in `g1` */
+        double g2gGrid( const Tpvec &p, Group &g1, Group &g2 )
+        {
+            double u = 0;
+            for ( auto i : g1 )
+                neighbors(p, p[i], [&]( int j ) {
+                    if ( g2.find(j) && !g1.find(j) )
+                        u += pairEnergy(p, i, j);
+                });
+            return u;
+        }
+
+    public:
+        NonbondedCellList( Tmjson &j, const string &sec = "nonbonded" ) : base(j, sec),
+            gridValid(false), changeKnown(false)
+        {
+            double rc2 = pc::infty;
+            auto &m = pairpot.rcut2.m;
+            if ( !m.empty())
+            {
+                rc2 = 0;
+                for ( auto &row : m )
+                    for ( auto r2 : row )
+                        rc2 = (r2 > 0) ? std::max(rc2, r2) : pc::infty;
+            }
+            rc = j["energy"][sec].value("cutoff_p2p", std::sqrt(rc2));
+            useCache = j["energy"][sec].value("energy_cache", false);
+            if ( rc >= pc::infty )
+                std::cerr << "Warning: no pair cutoff given; cell list is disabled.\n";
+            base::name += " (cell list)";
+        }
+
+        void setSpace( Tspace &s ) override
+        {
+            base::setSpace(s);
+            gridValid = false;
+        }
+
+        double i2all( Tpvec &p, int i ) override
+        {
+            if ( !useGrid(p))
+                return base::i2all(p, i);
+            if ( useCache && &p == &base::spc->p )
+            {
+                lookup(i);
+                return ucache[i];
+            }
+            double u = 0;
+            neighbors(p, p[i], [&]( int j ) { if ( j != i ) u += pairEnergy(p, i, j); });
+            return u;
+        }
+
+        double g2g( const Tpvec &p, Group &g1, Group &g2 ) override
+        {
+            if ( g1.empty() || g2.empty())
+                return 0;
+            if ( !useGrid(p))
+                return base::g2g(p, g1, g2);
+            // loop over smallest group; also handles sub-groups
+            return (g1.size() <= g2.size()) ? g2gGrid(p, g1, g2) : g2gGrid(p, g2, g1);
+        }
+
+        double g_internal( const Tpvec &p, Group &g ) override
+        {
+            if ( g.empty())
+                return 0;
+            if ( !useGrid(p))
+                return base::g_internal(p, g);
+            double u = 0;
+            for ( auto i : g )
+                neighbors(p, p[i], [&]( int j ) {
+                    if ( j > i && g.find(j) )
+                        u += pairEnergy(p, i, j);
+                });
+            return u + pairpot.internal(p, g);
+        }
+
+        double g2All( const Tpvec &p, const ChangeMap<vector<int>> &mg ) override
+        {
+            if ( !useGrid(p))
+                return base::g2All(p, mg);
+            auto &g = base::spc->groupList();
+            if ( useCache && mg.size() == 1 )
+            {   // unmoved particles interact with other groups as in spc->p
+                int k = mg.begin()->first;
+                bool accepted = &p == &base::spc->p;
+                double du = 0;
+                for ( auto i : *g[k] )
+                {
+                    if ( accepted || !moved[i] )
+                    {
+                        lookup(i);
+                        du += uother[i];
+                    }
+                    else
+                        neighbors(p, p[i], [&]( int j ) {
+                            if ( groupOf[j] >= 0 && groupOf[j] != k )
+                                du += pairEnergy(p, i, j);
+                        });
+                    if ( du == pc::infty )
+                        return pc::infty;   // early rejection
+                }
+                return du;
+            }
+            vector<char> isMoved(g.size(), 0);
+            for ( auto &m : mg )
+                isMoved[m.first] = 1;
+
+            double du = 0;
+            for ( auto &m : mg ) // moved <-> static particles
+            {
+                for ( auto i : *g[m.first] )
+                    neighbors(p, p[i], [&]( int j ) {
+                        int k = groupOf[j];
+                        if ( k >= 0 && !isMoved[k] )
+                            du += pairEnergy(p, i, j);
+                    });
+                if ( du == pc::infty )
+                    return pc::infty;   // early rejection
+            }
+            for ( auto i = mg.begin(); i != mg.end(); ++i ) // moved <-> moved
+                for ( auto j = std::next(i); j != mg.end(); ++j )
+                {
+                    du += g2g(p, *g[i->first], *g[j->first]);
+                    if ( du == pc::infty )
+                        return pc::infty;
+                }
+            return du;
+        }
+
+        double systemEnergy( const Tpvec &p ) override
+        {
+            if ( &p == &base::spc->p )
+                gridValid = false; // positions may have been set outside of moves
+            return base::systemEnergy(p);
+        }
+
+        bool isReentrant() override { return false; } // grid and caches are updated on demand
+
+        /** @brief Fraction of cached energy lookups that were hits */
+        double cacheHitRatio() const { return (lookups > 0) ? double(hits) / lookups : 0; }
+
+        double updateChange( const typename Tspace::Change &c ) override
+        {
+            changeKnown = false;
+            if ( useGrid(base::spc->p))
+                if ( !c.empty() && !c.geometryChange && c.rmGroup.empty() && c.inGroup.empty())
+                {
+                    auto &g = base::spc->groupList();
+                    auto add = [&]( int i ) {
+                        if ( !moved[i] )
+                        {
+                            moved[i] = 1;
+                            movedList.push_back(i);
+                            if ( useCache )
+                                movedFrom.push_back(base::spc->p[i]);
+                        }
+                    };
+                    for ( auto &m : c.mvGroup )
+                    {
+                        if ( m.second.empty()) // empty list = entire group moved
+                        {
+                            for ( auto i : *g[m.first] )
+                                add(i);
+                        }
+                        else
+                            for ( auto i : m.second )
+                                add(i);
+                    }
+                    changeKnown = true;
+                }
+            return base::updateChange(c);
+        }
+
+        double update( bool acc ) override
+        {
+            if ( gridValid )
+            {
+                if ( changeKnown )
+                {
+                    if ( acc && useCache )
+                        for ( size_t k = 0; k < movedList.size(); k++ )
+                        {   // invalidate neighbors at old and new positions
+                            auto stale = [&]( int j ) { fresh[j] = 0; };
+                            grid.forEachNeighbor(movedFrom[k], stale);
+                            grid.forEachNeighbor(base::spc->p[movedList[k]], stale);
+                            fresh[movedList[k]] = 0;
+                        }
+                    if ( acc )
+                        for ( auto i : movedList )
+                            grid.move(i, base::spc->p[i]);
+                }
+                else if ( acc ) // unknown change to spc->p
+                    gridValid = false;
+                for ( auto i : movedList )
+                    moved[i] = 0;
+                movedList.clear();
+                movedFrom.clear();
+            }
+            changeKnown = false;
+            return base::update(acc);
+        }
+
+        auto tuple() -> decltype(std::make_tuple(this))
+        {
+            return std::make_tuple(this);
+        }
+    };
+
 /**
      * @brief Class for handling bond pairs
      *
@@ -1511,6 +2080,12 @@ namespace Faunus
      *     double rij2 = ... ;                 // squared distance between i and j
      *     double u = b(i,j)( p[i], p[j], rij2 ); // i j bond energy in kT
      *
+     * Energies are evaluated from a compressed sparse row (CSR) adjacency
+     * of each particle's bonds, built when needed after bonds are added.
+     * Parameters of `Potential::Harmonic` and `Potential::FENE` bonds are
+     * kept in flat arrays per bond type and evaluated inline, while other
+     * potentials are called through `std::function`.
+     *
      * @date Lund, 2011-2012
      */
     template<class Tspace>
@@ -1534,12 +2109,133 @@ namespace Faunus
 
         string _infolist;
 
+        enum BondType { HARMONIC = 0, FENE = 1, GENERIC = 2 };
+
+        struct BondParameters
+        {
+            BondType type;
+            double k, r;    // harmonic: k, req; FENE: k, r02
+        };
+
+        /* parameters of bonds added through typed `add()`; all bonds are also in `Tbase::list` */
+        std::map<typename Tbase::Tpair, BondParameters> typed;
+
+        /** @brief Flat bond arrays grouped by type and CSR adjacency, built from `Tbase::list` */
+        struct Topology
+        {
+            vector<int> hi, hj, fi, fj, gi, gj; // bonded particles of each type
+            vector<double> hk, hreq;            // harmonic
+            vector<double> fk, fr02, fr02inv;   // FENE
+            vector<std::function<double( const Tparticle &, const Tparticle &, double )>> gf; // other potentials
+            vector<int> offset;                 // bonds of particle i are in [offset[i],offset[i+1])
+            vector<int> partner;                // bonded partner
+            vector<int> handle;                 // bond index within type times four plus type
+            bool valid = false;
+        } top;
+
+        void buildTopology()
+        {
+            Topology t;
+            int n = 0;
+            for ( auto &b : Tbase::list )
+            {
+                int i = b.first.first, j = b.first.second, h;
+                n = std::max(n, std::max(i, j) + 1);
+                auto it = typed.find(b.first);
+                if ( it != typed.end() && it->second.type == HARMONIC )
+                {
+                    h = 4 * t.hi.size() + HARMONIC;
+                    t.hi.push_back(i);
+                    t.hj.push_back(j);
+                    t.hk.push_back(it->second.k);
+                    t.hreq.push_back(it->second.r);
+                }
+                else if ( it != typed.end() && it->second.type == FENE )
+                {
+                    h = 4 * t.fi.size() + FENE;
+                    t.fi.push_back(i);
+                    t.fj.push_back(j);
+                    t.fk.push_back(it->second.k);
+                    t.fr02.push_back(it->second.r);
+                    t.fr02inv.push_back(1 / it->second.r);
+                }
+                else
+                {
+                    h = 4 * t.gi.size() + GENERIC;
+                    t.gi.push_back(i);
+                    t.gj.push_back(j);
+                    t.gf.push_back(b.second);
+                }
+                t.handle.push_back(h); // temporarily in bond order
+            }
+
+            // count bonds per particle, then fill rows
+            vector<int> bi, bj;
+            bi.reserve(t.handle.size());
+            bj.reserve(t.handle.size());
+            for ( auto &b : Tbase::list )
+            {
+                bi.push_back(b.first.first);
+                bj.push_back(b.first.second);
+            }
+            vector<int> h = t.handle;
+            t.offset.assign(n + 1, 0);
+            for ( size_t k = 0; k < h.size(); k++ )
+            {
+                t.offset[bi[k] + 1]++;
+                t.offset[bj[k] + 1]++;
+            }
+            for ( int i = 0; i < n; i++ )
+                t.offset[i + 1] += t.offset[i];
+            t.partner.resize(t.offset[n]);
+            t.handle.resize(t.offset[n]);
+            vector<int> fill(t.offset.begin(), t.offset.end() - 1);
+            for ( size_t k = 0; k < h.size(); k++ )
+            {
+                t.partner[fill[bi[k]]] = bj[k];
+                t.handle[fill[bi[k]]++] = h[k];
+                t.partner[fill[bj[k]]] = bi[k];
+                t.handle[fill[bj[k]]++] = h[k];
+            }
+            t.valid = true;
+            top = t;
+        }
+
+        inline const Topology &topology()
+        {
+            if ( !top.valid )
+                buildTopology();
+            return top;
+        }
+
+        /** @brief Energy of bond `h` between `i` and `j` */
+        inline double bond( const Tpvec &p, int h, int i, int j ) const
+        {
+            double r2 = spc->geo.sqdist(p[i], p[j]);
+            int n = h >> 2;
+            switch ( h & 3 )
+            {
+                case HARMONIC:
+                {
+                    double d = std::sqrt(r2) - top.hreq[n];
+                    return top.hk[n] * d * d;
+                }
+                case FENE:
+                    return (r2 > top.fr02[n]) ? pc::infty : -0.5 * top.fk[n] * top.fr02[n] * std::log(1 - r2 * top.fr02inv[n]);
+                default:
+                    return top.gf[n](p[i], p[j], r2);
+            }
+        }
+
         string _info() override
         {
             using namespace Faunus::textio;
             std::ostringstream o;
+            auto &t = topology();
             o << pad(SUB, 30, "Look for group-group bonds:")
               << std::boolalpha << CrossGroupBonds << endl
+              << pad(SUB, 30, "Harmonic/FENE/other bonds:")
+              << t.hi.size() << "/" << t.fi.size() << "/" << t.gi.size() << endl
               << indent(SUBSUB) << std::left
               << setw(7) << "i" << setw(7) << "j" << endl;
             return o.str() + _infolist;
@@ -1587,16 +2283,15 @@ namespace Faunus
             return std::make_tuple(this);
         }
 
-        /**
-             * @brief Bond energy i with j
-             * @todo Optimize by using iterator directly as returned by find.
-             */
+        /** @brief Bond energy i with j */
         double i2i( const Tpvec &p, int i, int j ) override
         {
             assert(i != j);
-            auto f = this->list.find(opair<int>(i, j));
-            if ( f != this->list.end())
-                return f->second(p[i], p[j], spc->geo.sqdist(p[i], p[j]));
+            auto &t = topology();
+            if ( i < (int) t.offset.size() - 1 )
+                for ( int k = t.offset[i], end = t.offset[i + 1]; k < end; k++ )
+                    if ( t.partner[k] == j )
+                        return bond(p, t.handle[k], i, j);
             return 0;
         }
 
@@ -1624,26 +2319,26 @@ namespace Faunus
         {
             assert(i >= 0 && i < (int) p.size()); //debug
             double u = 0;
-            auto eqr = this->mlist.equal_range(i);
-            for ( auto it = eqr.first; it != eqr.second; ++it )
-            {
-                int j = it->second; // partner index
-                u += this->list[opair<int>(i, j)](
-                    p[i], p[j], spc->geo.sqdist(p[i], p[j]));
-            }
+            auto &t = topology();
+            if ( i < (int) t.offset.size() - 1 )
+                for ( int k = t.offset[i], end = t.offset[i + 1]; k < end; k++ )
+                    u += bond(p, t.handle[k], i, t.partner[k]);
             return u;
         }
 
         double total( const Tpvec &p )
         {
             double u = 0;
-            for ( auto &m : Tbase::list )
+            auto &t = topology();
+            for ( size_t n = 0; n < t.hi.size(); n++ )
             {
-                int i = m.first.first;
-                int j = m.first.second;
-                assert(i >= 0 && i < (int) p.size() && j >= 0 && j < (int) p.size()); //debug
-                u += m.second(p[i], p[j], spc->geo.sqdist(p[i], p[j]));
+                double d = std::sqrt(spc->geo.sqdist(p[t.hi[n]], p[t.hj[n]])) - t.hreq[n];
+                u += t.hk[n] * d * d;
             }
+            for ( size_t n = 0; n < t.fi.size(); n++ )
+                u += bond(p, 4 * n + FENE, t.fi[n], t.fj[n]);
+            for ( size_t n = 0; n < t.gi.size(); n++ )
+                u += bond(p, 4 * n + GENERIC, t.gi[n], t.gj[n]);
             return u;
         }
 
@@ -1660,17 +2355,15 @@ namespace Faunus
         {
             double u = 0;
             if ( CrossGroupBonds )
+            {
+                auto &t = topology();
+                int n = t.offset.size() - 1;
                 for ( auto i : g1 )
-                {
-                    auto eqr = this->mlist.equal_range(i);
-                    for ( auto it = eqr.first; it != eqr.second; ++it )
-                    {
-                        int j = it->second; // partner index
-                        if ( g2.find(j))
-                            u += this->list[opair<int>(i, j)](
-                                p[i], p[j], spc->geo.sqdist(p[i], p[j]));
-                    }
-                }
+                    if ( i < n )
+                        for ( int k = t.offset[i], end = t.offset[i + 1]; k < end; k++ )
+                            if ( g2.find(t.partner[k]))
+                                u += bond(p, t.handle[k], i, t.partner[k]);
+            }
             return u;
         }
 
@@ -1685,29 +2378,16 @@ namespace Faunus
         double g_internal( const Tpvec &p, Group &g ) override
         {
             double u = 0;
-            if ( this->list.size() > pow(g.size(), 2))
-            {
-                // small group compared to bond list
-                auto end = this->list.end();
-                for ( auto i = g.front(); i < g.back(); i++ )
-                    for ( auto j = i + 1; j <= g.back(); j++ )
+            auto &t = topology();
+            int n = t.offset.size() - 1;
+            for ( auto i : g )
+                if ( i < n )
+                    for ( int k = t.offset[i], end = t.offset[i + 1]; k < end; k++ )
                     {
-                        auto it = this->list.find(opair<int>(i, j));
-                        if ( it != end )
-                            u += it->second(p[i], p[j], spc->geo.sqdist(p[i], p[j]));
+                        int j = t.partner[k];
+                        if ( j > i && g.find(j))
+                            u += bond(p, t.handle[k], i, j);
                     }
-            }
-            else
-            {
-                // big group compared to bond list
-                for ( auto &m : this->list )
-                {
-                    int i = m.first.first, j = m.first.second;
-                    if ( g.find(i))
-                        if ( g.find(j))
-                            u += m.second(p[i], p[j], spc->geo.sqdist(p[i], p[j]));
-                }
-            }
             return u;
         }
 
@@ -1722,13 +2402,31 @@ namespace Faunus
             Tbase::add(i, j, pot);// create and add functor to pair list
             force_list[typename Tbase::Tpair(i, j)]
                 = ForceFunctionObject<decltype(pot)>(pot);
+            typed.erase(typename Tbase::Tpair(i, j));
+            top.valid = false;
+        }
+
+        /** @brief Add harmonic bond, evaluated inline */
+        void add( int i, int j, Potential::Harmonic pot )
+        {
+            add<Potential::Harmonic>(i, j, pot);
+            typed[typename Tbase::Tpair(i, j)] = {HARMONIC, pot.k, pot.req};
+        }
+
+        /** @brief Add FENE bond, evaluated inline */
+        void add( int i, int j, Potential::FENE pot )
+        {
+            add<Potential::FENE>(i, j, pot);
+            typed[typename Tbase::Tpair(i, j)] = {FENE, pot.k, pot.r02};
         }
 
-        /** @brief Add harmonic bond */
+        /** @brief Add harmonic or FENE bond */
         void add( const Faunus::Bonded::BondData &hb )
         {
             if ( hb.type == Faunus::Bonded::BondData::Type::HARMONIC )
                 add(hb.index.at(0), hb.index.at(1), Potential::Harmonic(hb.k, hb.req));
+            if ( hb.type == Faunus::Bonded::BondData::Type::FENE )
+                add(hb.index.at(0), hb.index.at(1), Potential::FENE(hb.k, hb.req));
         }
 
         /** @brief Add all bonds found in a list of groups */
@@ -1751,6 +2449,9 @@ namespace Faunus
         {
             _infolist.clear();
             Tbase::clear();
+            typed.clear();
+            force_list.clear();
+            top.valid = false;
         }
 
     };
@@ -1891,6 +2592,20 @@ namespace Faunus
             double V = this->getSpace().geo.getVolume();
             return -N * log(V);
         }
+
+        bool isReentrant() override { return true; }
+
+        /** @brief Change of `external()` and `g_external()` for all groups */
+        double scaleChange( double ) override
+        {
+            auto &s = this->getSpace();
+            double V = s.geo.getVolume(), Vnew = s.geo_trial.getVolume();
+            int N = 0;
+            for ( auto g : s.groupList())
+                if ( ignore.count(g) == 0 )
+                    N += g->numMolecules();
+            return P * (Vnew - V) - (N + 1) * log(Vnew / V);
+        }
     };
 
 /**
@@ -2925,10 +3640,13 @@ namespace Faunus
      * pot.add( Potential::Angular( {3,4,5}, 70., 0.5 ) );
      * ~~~~
      *
-     * @todo Currently implemented as `external()` which means
-     * that all added potentials are evaluated for each move
-     * eventhough only a subset of atoms are touched. Implement
-     * dictionary to speed up.
+     * `Potential::Angular` and `Potential::Dihedral` terms are unpacked
+     * into contiguous arrays while other potentials are stored as generic
+     * functors. A reverse index from particle to terms is used so that,
+     * when the change of a move is known (`updateChange()`), only terms
+     * involving moved particles are evaluated; the energy of the accepted
+     * configuration is kept as a running total. Unknown changes, i.e.
+     * volume moves and insertions, fall back to evaluating all terms.
      */
     template<class Tspace>
     class Manybody : public Energybase<Tspace>
@@ -2938,7 +3656,14 @@ namespace Faunus
 
         string _info() override
         {
-            return _infosum;
+            std::ostringstream o;
+            o << _infosum
+              << textio::pad(textio::SUB, 25, "Angles") << angleK.size() << "\n"
+              << textio::pad(textio::SUB, 25, "Dihedrals") << dihedralK.size() << "\n"
+              << textio::pad(textio::SUB, 25, "Other terms") << list.size() << "\n";
+            if ( evaluated > 0 )
+                o << textio::pad(textio::SUB, 25, "Terms evaluated/move") << evaluated / double(moves) << "\n";
+            return o.str();
         }
 
         typedef Energybase<Tspace> Tbase;
@@ -2946,9 +3671,107 @@ namespace Faunus
 
         typedef std::function<double( typename Tbase::Tgeometry &, const Tpvec & )> EnergyFunct;
         vector <EnergyFunct> list;
+        vector <vector<int>> listIndex;
         std::set<int> allindex; // index of all particles involved
 
-    public:
+        enum { ANGLE = 0, DIHEDRAL = 1, FUNCTOR = 2 };
+
+        vector<int> angleIndex;           // i,j,k for each angle
+        vector<double> angleK, angleTheta0;
+        vector<int> dihedralIndex;        // i,j,k,l for each dihedral
+        vector<double> dihedralK, dihedralN, dihedralPhi0;
+
+        vector<int> offset;               // CSR: terms of particle i are handle[offset[i]:offset[i+1]]
+        vector<int> handle;               // term handle = 3*n + type
+        vector<char> mark;                // per handle, used to collect unique terms
+        bool indexValid = false;
+
+        vector<int> touched;              // handles of terms involving moved particles
+        bool changeKnown = false;
+        bool totalValid = false;          // `utotal` matches spc->p
+        bool deltaKnown = false;
+        double utotal = 0;                // energy of all terms in spc->p
+        double udelta = 0;                // trial minus current energy of `touched`
+        unsigned long evaluated = 0, moves = 0;
+
+        void buildIndex()
+        {
+            int n = allindex.empty() ? 0 : *allindex.rbegin() + 1;
+            vector<vector<int>> terms(n);
+            for ( size_t a = 0; a < angleK.size(); a++ )
+                for ( int d = 0; d < 3; d++ )
+                    terms[angleIndex[3 * a + d]].push_back(3 * a + ANGLE);
+            for ( size_t a = 0; a < dihedralK.size(); a++ )
+                for ( int d = 0; d < 4; d++ )
+                    terms[dihedralIndex[4 * a + d]].push_back(3 * a + DIHEDRAL);
+            for ( size_t a = 0; a < list.size(); a++ )
+                for ( auto i : listIndex[a] )
+                    terms[i].push_back(3 * a + FUNCTOR);
+            offset.assign(1, 0);
+            handle.clear();
+            for ( auto &t : terms )
+            {
+                std::sort(t.begin(), t.end());
+                t.erase(std::unique(t.begin(), t.end()), t.end());
+                handle.insert(handle.end(), t.begin(), t.end());
+                offset.push_back(handle.size());
+            }
+            mark.assign(3 * std::max(angleK.size(), std::max(dihedralK.size(), list.size())), 0);
+            indexValid = true;
+        }
+
+        /** @brief Energy of a single term */
+        inline double term( const Tpvec &p, int h )
+        {
+            auto &geo = Tbase::spc->geo;
+            int n = h / 3;
+            switch ( h % 3 )
+            {
+                case ANGLE:
+                {
+                    const int *i = &angleIndex[3 * n];
+                    return Potential::Angular::energy(geo, p, i[0], i[1], i[2], angleK[n], angleTheta0[n]);
+                }
+                case DIHEDRAL:
+                {
+                    const int *i = &dihedralIndex[4 * n];
+                    return Potential::Dihedral::energy(geo, p, i[0], i[1], i[2], i[3],
+                                                       dihedralK[n], dihedralN[n], dihedralPhi0[n]);
+                }
+            }
+            return list[n](geo, p);
+        }
+
+        /** @brief Energy of all terms */
+        double total( const Tpvec &p )
+        {
+            auto &geo = Tbase::spc->geo;
+            double u = 0;
+            for ( size_t n = 0; n < angleK.size(); n++ )
+            {
+                const int *i = &angleIndex[3 * n];
+                u += Potential::Angular::energy(geo, p, i[0], i[1], i[2], angleK[n], angleTheta0[n]);
+            }
+            for ( size_t n = 0; n < dihedralK.size(); n++ )
+            {
+                const int *i = &dihedralIndex[4 * n];
+                u += Potential::Dihedral::energy(geo, p, i[0], i[1], i[2], i[3],
+                                                 dihedralK[n], dihedralN[n], dihedralPhi0[n]);
+            }
+            for ( auto &f : list )
+                u += f(geo, p);
+            return u;
+        }
+
+        void added( const vector<int> &index, const string &brief )
+        {
+            _infosum += "  " + brief + "\n";
+            for ( auto i : index )
+                allindex.insert(i);
+            indexValid = totalValid = false;
+        }
+
+    public:
         Manybody( Tspace &spc )
         {
             Tbase::name = "Manybody potential";
@@ -2956,116 +3779,727 @@ namespace Faunus
         }
 
         /**
-               * @brief Add a manybody potential
-               */
+         * @brief Add a manybody potential
+         *
+         * The potential must provide `getIndex()`, `brief()` and
+         * `operator()(geometry, particles)`.
+         */
         template<class Tmanybodypot>
         void add( const Tmanybodypot &f )
         {
+            auto index = f.getIndex();
             list.push_back(f);
-            _infosum += "  " + f.brief() + "\n";
-            for ( auto i : f.getIndex())
-                allindex.insert(i);
+            listIndex.push_back(vector<int>(index.begin(), index.end()));
+            added(listIndex.back(), f.brief());
+        }
+
+        /** @brief Add angular potential; stored in contiguous arrays */
+        void add( const Potential::Angular &f )
+        {
+            auto &i = f.getIndex();
+            angleIndex.insert(angleIndex.end(), i.begin(), i.end());
+            angleK.push_back(f.k);
+            angleTheta0.push_back(f.theta0);
+            added(i, f.brief());
+        }
+
+        /** @brief Add dihedral potential; stored in contiguous arrays */
+        void add( const Potential::Dihedral &f )
+        {
+            auto &i = f.getIndex();
+            dihedralIndex.insert(dihedralIndex.end(), i.begin(), i.end());
+            dihedralK.push_back(f.k);
+            dihedralN.push_back(f.n);
+            dihedralPhi0.push_back(f.phi0);
+            added(i, f.brief());
+        }
+
+        /** @brief Number of terms involving moved particles in the current change */
+        size_t numTouched() const { return changeKnown ? touched.size() : 0; }
+
+        double updateChange( const typename Tspace::Change &c ) override
+        {
+            for ( auto h : touched )
+                mark[h] = 0;
+            touched.clear();
+            changeKnown = deltaKnown = false;
+            if ( !c.empty() && !c.geometryChange && c.rmGroup.empty() && c.inGroup.empty())
+            {
+                if ( !indexValid )
+                    buildIndex();
+                int n = int(offset.size()) - 1;
+                auto collect = [&]( int i ) {
+                    if ( i < n )
+                        for ( int k = offset[i]; k < offset[i + 1]; k++ )
+                            if ( !mark[handle[k]] )
+                                mark[handle[k]] = 1, touched.push_back(handle[k]);
+                };
+                auto &g = Tbase::spc->groupList();
+                for ( auto &m : c.mvGroup )
+                    if ( m.second.empty()) // empty list = entire group moved
+                        for ( auto i : *g[m.first] )
+                            collect(i);
+                    else
+                        for ( auto i : m.second )
+                            collect(i);
+                changeKnown = true;
+            }
+            return Tbase::updateChange(c);
         }
 
         double external( const Tpvec &p ) override
         {
-            double u = 0;
-            for ( auto &f : list )
-                u += f(Tbase::spc->geo, p);
+            auto &spc = *Tbase::spc;
+            if ( changeKnown && (&p == &spc.p || &p == &spc.trial))
+            {
+                if ( !totalValid )
+                    utotal = total(spc.p), totalValid = true;
+                if ( &p == &spc.p )
+                    return utotal;
+                udelta = 0;
+                for ( auto h : touched )
+                    udelta += term(p, h) - term(spc.p, h);
+                evaluated += touched.size();
+                moves++;
+                deltaKnown = true;
+                return utotal + udelta;
+            }
+            double u = total(p);
+            if ( &p == &spc.p )
+                utotal = u, totalValid = true;
             return u;
         }
+
+        double update( bool acc ) override
+        {
+            if ( acc )
+            {
+                if ( changeKnown && deltaKnown && totalValid && std::isfinite(udelta))
+                    utotal += udelta;
+                else
+                    totalValid = false; // unknown change to spc->p
+            }
+            for ( auto h : touched )
+                mark[h] = 0;
+            touched.clear();
+            changeKnown = deltaKnown = false;
+            return Tbase::update(acc);
+        }
     };
 
-#ifdef FAU_POWERSASA
-/**
- * @brief SASA energy from transfer free energies
- *
- * Detailed description here...
- */
-template<class Tspace>
-class SASAEnergy : public Energybase<Tspace> {
+    /**
+     * @brief SASA energy from transfer free energies
+     *
+     * The energy is the sum over particles of the solvent accessible surface
+     * area times the atomic transfer free energy, `tfe`, and the co-solute
+     * concentration. Areas are calculated in-tree by `SASA::ShrakeRupley`
+     * and kept per particle for the accepted configuration: when the moved
+     * particles are known from `updateChange()` only these and their
+     * overlapping neighbors are recalculated. Volume moves, insertions and
+     * unknown changes fall back to a full calculation, as does the energy of
+     * `Space::p` outside a pending change.
+     *
+     * Upon construction the `Tmjson` is searched for the following in
+     * section `energy/sasaenergy/`:
+     *
+     * Keyword       |  Description
+     * :------------ |  :------------------------------------
+     * `proberadius` |  Probe radius (angstrom) [default: 1.4]
+     * `conc`        |  Co-solute concentration (mol/l) [default: 0]
+     * `points`      |  Surface points per particle [default: 400]
+     */
+    template<class Tspace>
+    class SASAEnergy : public Energybase<Tspace>
+    {
     private:
-        vector<double> tfe; // transfer free energies (1/angstrom^2)
-        vector<double> sasa; // transfer free energies (1/angstrom^2)
-        vector<Point> sasaCoords;
-        vector<double> sasaWeights;
-        double probe; // sasa probe radius (angstrom)
-        double conc;  // co-solute concentration (mol/l)
-        Average<double> avgArea; // average surface area
-
         typedef Energybase<Tspace> base;
         typedef typename base::Tpvec Tpvec;
 
-        string _info() override {
-            char w=20;
+        double conc;                // co-solute concentration (mol/l)
+        SASA::ShrakeRupley sasa;    // areas of spc->p
+        bool valid = false;         // `sasa` and `usum` reflect spc->p
+        bool changeKnown = false;
+        bool deltaKnown = false;
+        double usum = 0;            // sum of tfe*area of spc->p (kT*l/mol)
+        double udelta = 0;          // change in `usum` in trial vector
+        vector<int> movedList;
+        Average<double> avgArea;    // average surface area
+        Average<double> avgChanged; // recalculated particles per move
+
+        string _info() override
+        {
+            char w = 20;
             std::ostringstream o;
-            o << textio::pad(textio::SUB,w,"Probe radius")
-                << probe << textio::_angstrom << "\n"
-                << textio::pad(textio::SUB,w,"Co-solute conc.")
-                << conc << " mol/l\n"
-                << textio::pad(textio::SUB,w,"Average area")
-                << avgArea.avg() << textio::_angstrom+textio::squared << "\n";
+            o << textio::pad(textio::SUB, w, "Probe radius")
+              << sasa.probeRadius() << textio::_angstrom << "\n"
+              << textio::pad(textio::SUB, w, "Co-solute conc.")
+              << conc << " mol/l\n"
+              << textio::pad(textio::SUB, w, "Surface points")
+              << sasa.numPoints() << "\n"
+              << textio::pad(textio::SUB, w, "Average area")
+              << avgArea.avg() << textio::_angstrom + textio::squared << "\n";
+            if ( avgChanged.cnt > 0 )
+                o << textio::pad(textio::SUB, w, "Updated atoms/move") << avgChanged.avg() << "\n";
             return o.str();
         }
 
-        template<class Tpvec>
-            void updateSASA(const Tpvec &p) {
-                size_t n=p.size(); // number of particles
-                sasa.resize(n);
-                sasaCoords.resize(n);
-                sasaWeights.resize(n);
-
-                for (size_t i=0; i<n; ++i) {
-                    sasaCoords[i]  = p[i];
-                    sasaWeights[i] = p[i].radius + probe;
-                }
+        /** @brief Transfer free energy of particle (kT/angstrom^2/M) */
+        template<class Tparticle>
+        inline double tfe( const Tparticle &a ) const
+        {
+            return atom[a.id].tfe / (pc::kT() * pc::Nav);
+        }
 
-                // generate powersasa object and calc. sasa for all particles
-                POWERSASA::PowerSasa<double,Point> ps(sasaCoords, sasaWeights, 1, 1, 1, 1);
-                ps.calc_sasa_all();
-                for (size_t i=0; i<n; ++i)
-                    sasa[i] = ps.getSasa()[i];
-            }
+        void rebuild()
+        {
+            auto &p = base::spc->p;
+            sasa.build(base::spc->geo, p);
+            usum = 0;
+            for ( size_t i = 0; i < p.size(); i++ )
+                usum += sasa.areas()[i] * tfe(p[i]);
+            valid = true;
+        }
 
     public:
-        SASAEnergy(Tmjson &j, const string &dir="sasaenergy") : base(dir) {
+        SASAEnergy( Tmjson &j, const string &dir = "sasaenergy" ) : base(dir),
+            sasa(j["energy"][dir]["proberadius"] | 1.4, j["energy"][dir]["points"] | 400)
+        {
             base::name = "SASA Energy";
-            auto _j = j["energy"][dir];
-            probe = _j["proberadius"] | 1.4; // angstrom
-            conc = _j["conc"] | 0.0;         // co-solute concentratil (mol/l);
+            conc = j["energy"][dir]["conc"] | 0.0; // co-solute concentration (mol/l)
         }
 
-        auto tuple() -> decltype(std::make_tuple(this)) {
+        auto tuple() -> decltype(std::make_tuple(this))
+        {
             return std::make_tuple(this);
         }
 
+        void setSpace( Tspace &s ) override
+        {
+            base::setSpace(s);
+            valid = false;
+        }
+
+        /** @brief Areas of particles in `Space::p` (angstrom^2) */
+        const vector<double> &areas()
+        {
+            if ( !valid || sasa.size() != base::spc->p.size())
+                rebuild();
+            return sasa.areas();
+        }
+
+        double updateChange( const typename Tspace::Change &c ) override
+        {
+            movedList.clear();
+            changeKnown = deltaKnown = false;
+            if ( !c.empty() && !c.geometryChange && c.rmGroup.empty() && c.inGroup.empty())
+            {
+                auto &g = base::spc->groupList();
+                for ( auto &m : c.mvGroup )
+                    if ( m.second.empty()) // empty list = entire group moved
+                        movedList.insert(movedList.end(), g[m.first]->begin(), g[m.first]->end());
+                    else
+                        movedList.insert(movedList.end(), m.second.begin(), m.second.end());
+                changeKnown = true;
+            }
+            return base::updateChange(c);
+        }
+
         /**
          * @brief The SASA calculation is implemented
          * as an external potential, only
          */
-        double external(const Tpvec &p) override {
-            // if first run, resize and fill tfe vector
-            if (tfe.size()!=p.size()) {
-                tfe.resize(p.size());
-                for (size_t i=0; i<p.size(); ++i)
-                    tfe[i] = atom[ p[i].id ].tfe / (pc::kT() * pc::Nav); // -> kT
-            }
-
-            // calc. sasa and energy
-            updateSASA(p);
-            assert(sasa.size() == p.size());
-            double u=0, A=0;
-            for (size_t i=0; i<sasa.size(); ++i) {
-                u += sasa[i] * tfe[i]; // a^2 * kT/a^2/M -> kT/M
-                if (!this->isTrial(p))
-                    A+=sasa[i];
-            }
-            if (!this->isTrial(p))
-                avgArea+=A; // sample average area for accepted confs. only
-            return u * conc; // -> kT
-        }
-};
+        double external( const Tpvec &p ) override
+        {
+            auto &spc = *base::spc;
+            if ( &p == &spc.p )
+            {
+                if ( !valid || !changeKnown || sasa.size() != p.size())
+                    rebuild(); // cached areas are trusted only within updateChange()/update()
+                avgArea += sasa.total(); // sample average area for accepted confs. only
+                return usum * conc;
+            }
+            if ( base::isTrial(p) && changeKnown && p.size() == spc.p.size())
+            {
+                if ( !valid || sasa.size() != p.size())
+                    rebuild();
+                if ( sasa.trial(base::getGeometry(), spc.p, p, movedList))
+                {
+                    auto &changed = sasa.changed();
+                    auto &A = sasa.changedAreas();
+                    udelta = 0;
+                    for ( size_t k = 0; k < changed.size(); k++ )
+                    {
+                        int i = changed[k];
+                        udelta += A[k] * tfe(p[i]) - sasa.areas()[i] * tfe(spc.p[i]);
+                    }
+                    avgChanged += changed.size();
+                    deltaKnown = true;
+                    return (usum + udelta) * conc;
+                }
+            }
+            // full calculation
+            SASA::ShrakeRupley full(sasa.probeRadius(), sasa.numPoints());
+            full.build(base::getGeometry(), p);
+            double u = 0;
+            for ( size_t i = 0; i < p.size(); i++ )
+                u += full.areas()[i] * tfe(p[i]);
+            return u * conc;
+        }
+
+        double update( bool acc ) override
+        {
+            if ( acc )
+            {
+                if ( valid && changeKnown && deltaKnown )
+                {
+                    sasa.accept(base::spc->p);
+                    usum += udelta;
+                }
+                else
+                    valid = false; // unknown change to spc->p
+            }
+            else
+                sasa.reject();
+            movedList.clear();
+            changeKnown = deltaKnown = false;
+            return base::update(acc);
+        }
+    };
+
+    /**
+     * @brief Trait for energy terms where the external energy is a sum over particles
+     *
+     * For such terms `g_external()` equals the sum of `p_external()` over the
+     * group which allows `StaticHamiltonian` to evaluate several of them in a
+     * single loop over particles.
+     */
+    template<class Tenergy>
+    struct is_particle_external : public std::false_type {};
+
+    template<class Tspace, class Texpot>
+    struct is_particle_external<ExternalPotential<Tspace, Texpot>> : public std::true_type {};
+
+    /**
+     * @brief Trait for energy terms where all pair energies are obtained from `Nonbonded::i2range()`
+     *
+     * Allows `StaticHamiltonian` to evaluate pair and `is_particle_external`
+     * terms in a single loop over particles. Only `Nonbonded` itself
+     * qualifies as derived classes may override the group energies.
+     */
+    template<class Tenergy>
+    struct is_pair_term : public std::false_type {};
+
+    template<class Tspace, class Tpairpot>
+    struct is_pair_term<Nonbonded<Tspace, Tpairpot>> : public std::true_type {};
+
+    /**
+     * @brief Non-virtual list of energy terms used by `StaticHamiltonian`
+     *
+     * Calls are qualified with the type of each term and are thus resolved
+     * at compile time, allowing the compiler to inline across terms.
+     */
+    template<class Tspace, class... Tterms>
+    struct HamiltonianTerms
+    {
+        typedef typename Energybase<Tspace>::Tparticle Tparticle;
+        typedef typename Energybase<Tspace>::Tpvec Tpvec;
+
+        static const bool fused = false; //!< True if any term is `is_particle_external`
+        static const bool paired = false; //!< True if any term is `is_pair_term`
+
+        std::tuple<> tuple() { return std::tuple<>(); }
+
+        string info() { return string(); }
+
+        void setSpace( Tspace & ) {}
+
+        void setGeometry( typename Tspace::GeometryType & ) {}
+
+        double p2p( const Tparticle &, const Tparticle & ) { return 0; }
+
+        Point f_p2p( const Tparticle &, const Tparticle & ) { return Point(0, 0, 0); }
+
+        double all2p( const Tpvec &, const Tparticle & ) { return 0; }
+
+        double i2i( const Tpvec &, int, int ) { return 0; }
+
+        double i2g( const Tpvec &, Group &, int ) { return 0; }
+
+        double i2all( Tpvec &, int ) { return 0; }
+
+        double i2range( const Tpvec &, int, int, int ) { return 0; }
+
+        double i2all_unpaired( Tpvec &, int ) { return 0; }
+
+        double i_external( const Tpvec &, int ) { return 0; }
+
+        double i_unfused( const Tpvec &, int ) { return 0; }
+
+        double i_internal( const Tpvec &, int ) { return 0; }
+
+        double p_external( const Tparticle & ) { return 0; }
+
+        double p_fused( const Tparticle & ) { return 0; }
+
+        double g2g( const Tpvec &, Group &, Group & ) { return 0; }
+
+        double g2g_unpaired( const Tpvec &, Group &, Group & ) { return 0; }
+
+        double g1g2( const Tpvec &, Group &, const Tpvec &, Group & ) { return 0; }
+
+        double g_unfused( const Tpvec &, Group & ) { return 0; }
+
+        double g_internal( const Tpvec &, Group & ) { return 0; }
+
+        double g_internal_unpaired( const Tpvec &, Group & ) { return 0; }
+
+        double g2All( const Tpvec &, const ChangeMap<vector<int>> & ) { return 0; }
+
+        double v2v( const Tpvec &, const Tpvec & ) { return 0; }
+
+        double external( const Tpvec & ) { return 0; }
+
+        double update( bool ) { return 0; }
+
+        double updateChange( const typename Tspace::Change & ) { return 0; }
+
+        double scaleChange( double ) { return 0; }
+
+        bool isReentrant() { return true; }
+
+        void field( const Tpvec &, Eigen::MatrixXd & ) {}
+    };
+
+    template<class Tspace, class T, class... Ts>
+    struct HamiltonianTerms<Tspace, T, Ts...>
+    {
+        typedef typename Energybase<Tspace>::Tparticle Tparticle;
+        typedef typename Energybase<Tspace>::Tpvec Tpvec;
+
+        static const bool fused = is_particle_external<T>::value || HamiltonianTerms<Tspace, Ts...>::fused;
+        static const bool paired = is_pair_term<T>::value || HamiltonianTerms<Tspace, Ts...>::paired;
+
+    private:
+        double pairRange( const Tpvec &p, int i, int a, int b, std::true_type ) { return first.T::i2range(p, i, a, b); }
+
+        double pairRange( const Tpvec &, int, int, int, std::false_type ) { return 0; }
+
+        double pairInternal( const Tpvec &p, Group &g, std::true_type ) { return first.pairpot.internal(p, g); }
+
+        double pairInternal( const Tpvec &, Group &, std::false_type ) { return 0; }
+
+    public:
+        T first;                            //!< First energy term
+        HamiltonianTerms<Tspace, Ts...> rest; //!< Remaining energy terms
+
+        HamiltonianTerms( const T &t, const Ts &... ts ) : first(t), rest(ts...) {}
+
+        auto tuple() -> decltype(std::tuple_cat(first.tuple(), rest.tuple()))
+        {
+            return std::tuple_cat(first.tuple(), rest.tuple());
+        }
+
+        string info() { return first.info() + rest.info(); }
+
+        void setSpace( Tspace &s )
+        {
+            first.setSpace(s);
+            rest.setSpace(s);
+        }
+
+        void setGeometry( typename Tspace::GeometryType &g )
+        {
+            first.setGeometry(g);
+            rest.setGeometry(g);
+        }
+
+        double p2p( const Tparticle &a, const Tparticle &b ) { return first.T::p2p(a, b) + rest.p2p(a, b); }
+
+        Point f_p2p( const Tparticle &a, const Tparticle &b ) { return first.T::f_p2p(a, b) + rest.f_p2p(a, b); }
+
+        double all2p( const Tpvec &p, const Tparticle &a ) { return first.T::all2p(p, a) + rest.all2p(p, a); }
+
+        double i2i( const Tpvec &p, int i, int j ) { return first.T::i2i(p, i, j) + rest.i2i(p, i, j); }
+
+        double i2g( const Tpvec &p, Group &g, int i ) { return first.T::i2g(p, g, i) + rest.i2g(p, g, i); }
+
+        double i2all( Tpvec &p, int i ) { return first.T::i2all(p, i) + rest.i2all(p, i); }
+
+        /** @brief Energy of `i` with particles `[a,b)` due to `is_pair_term` terms only */
+        double i2range( const Tpvec &p, int i, int a, int b )
+        {
+            return pairRange(p, i, a, b, is_pair_term<T>()) + rest.i2range(p, i, a, b);
+        }
+
+        /** @brief `i2all()` due to all terms but `is_pair_term` */
+        double i2all_unpaired( Tpvec &p, int i )
+        {
+            return (is_pair_term<T>::value ? 0 : first.T::i2all(p, i)) + rest.i2all_unpaired(p, i);
+        }
+
+        double i_external( const Tpvec &p, int i ) { return first.T::i_external(p, i) + rest.i_external(p, i); }
+
+        /** @brief `i_external()` due to all terms but `is_particle_external` */
+        double i_unfused( const Tpvec &p, int i )
+        {
+            return (is_particle_external<T>::value ? 0 : first.T::i_external(p, i)) + rest.i_unfused(p, i);
+        }
+
+        double i_internal( const Tpvec &p, int i ) { return first.T::i_internal(p, i) + rest.i_internal(p, i); }
+
+        double p_external( const Tparticle &a ) { return first.T::p_external(a) + rest.p_external(a); }
+
+        /** @brief External energy of particle due to `is_particle_external` terms only */
+        double p_fused( const Tparticle &a )
+        {
+            return (is_particle_external<T>::value ? first.T::p_external(a) : 0) + rest.p_fused(a);
+        }
+
+        double g2g( const Tpvec &p, Group &g1, Group &g2 ) { return first.T::g2g(p, g1, g2) + rest.g2g(p, g1, g2); }
+
+        /** @brief `g2g()` due to all terms but `is_pair_term` */
+        double g2g_unpaired( const Tpvec &p, Group &g1, Group &g2 )
+        {
+            return (is_pair_term<T>::value ? 0 : first.T::g2g(p, g1, g2)) + rest.g2g_unpaired(p, g1, g2);
+        }
+
+        double g1g2( const Tpvec &p1, Group &g1, const Tpvec &p2, Group &g2 )
+        {
+            return first.T::g1g2(p1, g1, p2, g2) + rest.g1g2(p1, g1, p2, g2);
+        }
+
+        /** @brief Group external energy due to all terms but `is_particle_external` */
+        double g_unfused( const Tpvec &p, Group &g )
+        {
+            return (is_particle_external<T>::value ? 0 : first.T::g_external(p, g)) + rest.g_unfused(p, g);
+        }
+
+        double g_internal( const Tpvec &p, Group &g ) { return first.T::g_internal(p, g) + rest.g_internal(p, g); }
+
+        /** @brief `g_internal()` without pairs of `is_pair_term` terms, i.e. only their `Tpairpot::internal()` */
+        double g_internal_unpaired( const Tpvec &p, Group &g )
+        {
+            return (is_pair_term<T>::value ? pairInternal(p, g, is_pair_term<T>()) : first.T::g_internal(p, g))
+                + rest.g_internal_unpaired(p, g);
+        }
+
+        double g2All( const Tpvec &p, const ChangeMap<vector<int>> &mg )
+        {
+            double du = first.T::g2All(p, mg);
+            if ( du == pc::infty )
+                return du; // early rejection
+            return du + rest.g2All(p, mg);
+        }
+
+        double v2v( const Tpvec &p1, const Tpvec &p2 ) { return first.T::v2v(p1, p2) + rest.v2v(p1, p2); }
+
+        double external( const Tpvec &p ) { return first.T::external(p) + rest.external(p); }
+
+        double update( bool acc ) { return first.T::update(acc) + rest.update(acc); }
+
+        double updateChange( const typename Tspace::Change &c ) { return first.T::updateChange(c) + rest.updateChange(c); }
+
+        double scaleChange( double s ) { return first.T::scaleChange(s) + rest.scaleChange(s); }
+
+        bool isReentrant() { return first.T::isReentrant() && rest.isReentrant(); }
+
+        void field( const Tpvec &p, Eigen::MatrixXd &E )
+        {
+            first.T::field(p, E);
+            rest.field(p, E);
+        }
+    };
+
+    /**
+     * @brief Hamiltonian composed of energy terms at compile time
+     *
+     * Drop-in replacement for adding energy terms with `+`, but
+     * with a flat list of terms that are called without virtual
+     * dispatch. Terms in `is_particle_external` share a single loop over
+     * particles when evaluating group external energies, and in
+     * `systemEnergy()` and `i_total()` this loop also evaluates the pair
+     * energies of `is_pair_term` terms. For example:
+     *
+     * ~~~~
+     * auto pot = Energy::makeHamiltonian(
+     *     Energy::Nonbonded<Tspace,Tpairpot>(mcp),
+     *     Energy::ExternalPotential<Tspace,Texpot>(mcp),
+     *     Energy::ExternalPressure<Tspace>(mcp) );
+     * auto nonbonded = std::get<0>( pot.tuple() );
+     * ~~~~
+     *
+     * Only the outermost call, e.g. from a move, is virtual.
+     *
+     * @note Pair and external terms are fused only where a single call
+     *       returns both. Moves that obtain `g2All()` and `g_external()`
+     *       from separate calls, e.g. in `Energy::energyChange()`, use
+     *       separate loops as a fused loop would count external energies
+     *       twice.
+     */
+    template<class Tspace, class... Tterms>
+    class StaticHamiltonian : public Energybase<Tspace>
+    {
+    private:
+        typedef Energybase<Tspace> Tbase;
+        typedef typename Tbase::Tparticle Tparticle;
+        typedef typename Tbase::Tpvec Tpvec;
+
+        string _info() override { return terms.info(); }
+
+    public:
+        HamiltonianTerms<Tspace, Tterms...> terms;
+
+        StaticHamiltonian( const Tterms &... t ) : terms(t...) { Tbase::name = "Static Hamiltonian"; }
+
+        auto tuple() -> decltype(terms.tuple()) { return terms.tuple(); }
+
+        string info() override { return _info(); }
+
+        void setSpace( Tspace &s ) override
+        {
+            terms.setSpace(s);
+            Tbase::setSpace(s);
+        }
+
+        void setGeometry( typename Tspace::GeometryType &g ) override
+        {
+            terms.setGeometry(g);
+            Tbase::setGeometry(g);
+        }
+
+        double p2p( const Tparticle &a, const Tparticle &b ) override { return terms.p2p(a, b); }
+
+        Point f_p2p( const Tparticle &a, const Tparticle &b ) override { return terms.f_p2p(a, b); }
+
+        double all2p( const Tpvec &p, const Tparticle &a ) override { return terms.all2p(p, a); }
+
+        double i2i( const Tpvec &p, int i, int j ) override { return terms.i2i(p, i, j); }
+
+        double i2g( const Tpvec &p, Group &g, int i ) override { return terms.i2g(p, g, i); }
+
+        double i2all( Tpvec &p, int i ) override { return terms.i2all(p, i); }
+
+        double i_external( const Tpvec &p, int i ) override { return terms.i_external(p, i); }
+
+        double i_internal( const Tpvec &p, int i ) override { return terms.i_internal(p, i); }
+
+        /** @brief As `Energybase::i_total()` but with pair and particle external energies of `i` in one pass */
+        double i_total( Tpvec &p, int i ) override
+        {
+            if ( !terms.paired )
+                return Tbase::i_total(p, i);
+            return terms.p_fused(p[i]) + terms.i2range(p, i, 0, i) + terms.i2range(p, i, i + 1, (int) p.size())
+                + terms.i2all_unpaired(p, i) + terms.i_unfused(p, i) + terms.i_internal(p, i);
+        }
+
+        double p_external( const Tparticle &a ) override { return terms.p_external(a); }
+
+        double g2g( const Tpvec &p, Group &g1, Group &g2 ) override { return terms.g2g(p, g1, g2); }
+
+        double g1g2( const Tpvec &p1, Group &g1, const Tpvec &p2, Group &g2 ) override
+        {
+            return terms.g1g2(p1, g1, p2, g2);
+        }
+
+        double g_external( const Tpvec &p, Group &g ) override
+        {
+            double u = terms.g_unfused(p, g);
+            if ( terms.fused )
+                for ( auto i : g )
+                    u += terms.p_fused(p[i]);
+            return u;
+        }
+
+        double g_internal( const Tpvec &p, Group &g ) override { return terms.g_internal(p, g); }
+
+        double g2All( const Tpvec &p, const ChangeMap<vector<int>> &mg ) override { return terms.g2All(p, mg); }
+
+        /**
+         * @brief Total energy with pair and particle external terms in a single loop over particles
+         *
+         * For each grouped particle, the `is_particle_external` energy and the
+         * `is_pair_term` energy with all following grouped particles are
+         * summed in one row. Rows are added in order so that the result is
+         * independent of the number of threads. Remaining terms are summed per
+         * group. Without pair terms, or if groups overlap,
+         * `Energybase::systemEnergy()` is used.
+         */
+        double systemEnergy( const Tpvec &p ) override
+        {
+            if ( !terms.paired )
+                return Tbase::systemEnergy(p);
+            auto &g = Tbase::spc->groupList();
+
+            // disjoint groups merged into contiguous spans, [first,last)
+            vector<std::pair<int, int>> spans;
+            for ( auto gi : g )
+                if ( !gi->empty())
+                    spans.push_back({gi->front(), gi->back() + 1});
+            std::sort(spans.begin(), spans.end());
+            size_t n = 0;
+            for ( size_t k = 0; k < spans.size(); k++ )
+            {
+                if ( n > 0 && spans[k].first < spans[n - 1].second )
+                    return Tbase::systemEnergy(p); // overlapping groups
+                if ( n > 0 && spans[k].first == spans[n - 1].second )
+                    spans[n - 1].second = spans[k].second;
+                else
+                    spans[n++] = spans[k];
+            }
+            spans.resize(n);
+
+            double u = terms.external(p);
+            for ( size_t a = 0; a < g.size(); a++ )
+            {
+                if ( !g[a]->empty())
+                    u += terms.g_unfused(p, *g[a]) + terms.g_internal_unpaired(p, *g[a]);
+                for ( size_t b = a + 1; b < g.size(); b++ )
+                    u += terms.g2g_unpaired(p, *g[a], *g[b]);
+            }
+
+            vector<std::pair<int, int>> rows; // grouped particles and their span
+            for ( size_t k = 0; k < spans.size(); k++ )
+                for ( int i = spans[k].first; i < spans[k].second; i++ )
+                    rows.push_back({i, k});
+            vector<double> r(rows.size());
+#ifdef _OPENMP
+            bool parallel = 0.5 * rows.size() * rows.size() > 4096 && terms.isReentrant();
+#pragma omp parallel for schedule (dynamic, 8) if (parallel)
 #endif
+            for ( int m = 0; m < (int) rows.size(); m++ )
+            {
+                int i = rows[m].first, k = rows[m].second;
+                double ui = terms.p_fused(p[i]) + terms.i2range(p, i, i + 1, spans[k].second);
+                for ( size_t l = k + 1; l < spans.size(); l++ )
+                    ui += terms.i2range(p, i, spans[l].first, spans[l].second);
+                r[m] = ui;
+            }
+            for ( auto ui : r )
+                u += ui;
+            return u;
+        }
+
+        double v2v( const Tpvec &p1, const Tpvec &p2 ) override { return terms.v2v(p1, p2); }
+
+        double external( const Tpvec &p ) override { return terms.external(p); }
+
+        double update( bool acc ) override { return terms.update(acc); }
+
+        double updateChange( const typename Tspace::Change &c ) override { return terms.updateChange(c); }
+
+        double scaleChange( double s ) override { return terms.scaleChange(s); }
+
+        bool isReentrant() override { return terms.isReentrant(); }
+
+        void field( const Tpvec &p, Eigen::MatrixXd &E ) override { terms.field(p, E); }
+    };
+
+    /** @brief Construct `StaticHamiltonian` from a list of energy terms */
+    template<class T, class... Ts>
+    StaticHamiltonian<typename T::SpaceType, T, Ts...> makeHamiltonian( const T &t, const Ts &... ts )
+    {
+        return StaticHamiltonian<typename T::SpaceType, T, Ts...>(t, ts...);
+    }
 
     /**
      * @brief Additive Hamiltonian
@@ -3309,21 +4743,12 @@ class SASAEnergy : public Energybase<Tspace> {
                 b->field(p, E);
         }
 
-        /**
-         * @brief systemEnergy Calculate System energy = external + internal + g2g() for all groups i,j from Space::Grouplist
-         *        A convenience function intented for easy Energy matrix integration of configuration-wide moves - such as isobaric move
-         * @param p
-         * @return
-         */
-        virtual double systemEnergy( const Tpvec &p )
+        bool isReentrant() override
         {
-            double u = external(p);
-            for ( auto g : Energybase<Tspace>::spc->groupList())
-                u += g_external(p, *g) + g_internal(p, *g);
-            for ( unsigned int i = 0; i < Energybase<Tspace>::spc->groupList().size() - 1; i++ )
-                for ( unsigned int j = i + 1; j < Energybase<Tspace>::spc->groupList().size(); j++ )
-                    u += g2g(p, *Energybase<Tspace>::spc->groupList()[i], *Energybase<Tspace>::spc->groupList()[j]);
-            return u;
+            for ( auto b : baselist )
+                if ( !b->isReentrant())
+                    return false;
+            return true;
         }
 
         /**
@@ -3611,7 +5036,7 @@ class SASAEnergy : public Energybase<Tspace> {
               second.field(p, E);
           }
 
-          double g2All(const Tpvec & p, const std::map<int, vector<int>>& mg) override
+          double g2All(const Tpvec & p, const ChangeMap<vector<int>>& mg) override
           {
               double a = first.g2All(p, mg);
               double b = second.g2All(p, mg);
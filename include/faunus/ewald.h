@@ -155,6 +155,98 @@ namespace Faunus {
       
   }//namespace
 
+  /**
+   * @brief Complex 3D fast Fourier transform on power-of-two grids
+   *
+   * Minimal radix-2 Cooley-Tukey transform used by `Energy::NonbondedSPME`
+   * so that no external FFT library is needed. Data is stored row-major,
+   * `index = (x*ny + y)*nz + z`. Transforms are unnormalized, i.e. a
+   * forward followed by a backward transform multiplies by `size()`.
+   */
+  class FFT3D {
+    private:
+      typedef std::complex<double> Tcomplex;
+      int n[3];
+      std::vector<int> rev[3];       // bit reversal permutation
+      std::vector<Tcomplex> tw[3];   // twiddle factors, exp(-2 pi i k/n)
+      std::vector<Tcomplex> line;    // scratch for strided lines
+
+      void transformLine(Tcomplex *a, int stride, int d, bool inverse) {
+        int m = n[d];
+        for (int i=0; i<m; i++)
+          line[rev[d][i]] = a[i*stride];
+        for (int len=2; len<=m; len<<=1) {
+          int half = len/2, step = m/len;
+          for (int i=0; i<m; i+=len)
+            for (int j=0; j<half; j++) {
+              Tcomplex w = inverse ? std::conj(tw[d][j*step]) : tw[d][j*step];
+              Tcomplex u = line[i+j], v = line[i+j+half]*w;
+              line[i+j] = u + v;
+              line[i+j+half] = u - v;
+            }
+        }
+        for (int i=0; i<m; i++)
+          a[i*stride] = line[i];
+      }
+
+      void transform(std::vector<Tcomplex> &a, bool inverse) {
+        assert(a.size() == size());
+        for (int x=0; x<n[0]; x++)
+          for (int y=0; y<n[1]; y++)
+            transformLine(&a[(x*n[1]+y)*n[2]], 1, 2, inverse);
+        for (int x=0; x<n[0]; x++)
+          for (int z=0; z<n[2]; z++)
+            transformLine(&a[x*n[1]*n[2]+z], n[2], 1, inverse);
+        for (int y=0; y<n[1]; y++)
+          for (int z=0; z<n[2]; z++)
+            transformLine(&a[y*n[2]+z], n[1]*n[2], 0, inverse);
+      }
+
+    public:
+      FFT3D(int nx=1, int ny=1, int nz=1) { resize(nx,ny,nz); }
+
+      static bool isPowerOfTwo(int m) { return m>0 && (m & (m-1))==0; }
+
+      /** @brief Smallest power of two not smaller than `m` */
+      static int nextPowerOfTwo(int m) {
+        int k=1;
+        while (k<m)
+          k<<=1;
+        return k;
+      }
+
+      void resize(int nx, int ny, int nz) {
+        n[0]=nx;
+        n[1]=ny;
+        n[2]=nz;
+        for (int d=0; d<3; d++) {
+          if (!isPowerOfTwo(n[d]))
+            throw std::runtime_error("FFT3D: grid size must be a power of two");
+          int bits=0;
+          while ((1<<bits) < n[d])
+            bits++;
+          rev[d].resize(n[d]);
+          for (int i=0; i<n[d]; i++) {
+            int r=0;
+            for (int b=0; b<bits; b++)
+              if (i & (1<<b))
+                r |= 1<<(bits-1-b);
+            rev[d][i]=r;
+          }
+          tw[d].resize(std::max(1,n[d]/2));
+          for (size_t k=0; k<tw[d].size(); k++)
+            tw[d][k] = std::polar(1.0, -2*pc::pi*k/n[d]);
+        }
+        line.resize(std::max(n[0],std::max(n[1],n[2])));
+      }
+
+      size_t size() const { return size_t(n[0])*n[1]*n[2]; }   //!< Number of grid points
+      int dim(int d) const { return n[d]; }                     //!< Grid points along dimension `d`
+
+      void forward(std::vector<Tcomplex> &a) { transform(a,false); }  //!< In-place transform, exp(-ikx)
+      void backward(std::vector<Tcomplex> &a) { transform(a,true); }  //!< In-place transform, exp(+ikx)
+  };
+
   namespace Energy {
 
     using namespace Faunus::Potential;
@@ -167,7 +259,10 @@ namespace Faunus {
      * 
      *  Keyword          |  Description
      * :--------------   | :---------------
-     * `delta`           |  Accuracy in system for energy (\f$ e^2/\AA \f$).                                                                 (Default: 5e-5)
+     * `delta`           |  Accuracy in system for energy (\f$ e^2/\AA \f$). Used if `tune` is true.                                        (Default: 5e-5)
+     * `tune`            |  Choose `alpha`, `cutoff` and `cutoffK` for accuracy `delta` by timing candidates on the first `setSpace()`.  (Default: false)
+     * `tune_cost`       |  Cost of tuning candidates: `timing` or a reproducible `estimate` from pairs within cutoff plus k-vectors.      (Default: `timing`)
+     * `tune_file`       |  Write tuned parameters to this file in input format, see `json()`.                                           (Default: none)
      * `eps_surf`        |  Dielectric constant of the surroundings                                                                          (Default: \f$ \varepsilon_r = \infty \f$)
      * `spherical_sum`   |  Spherical (or ellipsoid) summation in reciprocal space if set to be true. Cubic summation is applied if false.   (Default: true)
      * `cutoff`          |  Real space cut-off.                                                                                              (Default: Half the minimum box-length)              
@@ -207,7 +302,6 @@ namespace Faunus {
      * {\bf k} = 2\pi\left( \frac{n_x}{L_x} , \frac{n_y}{L_y} ,\frac{n_z}{L_z} \right)  \;\;,\;\; {\bf n} \in \mathbb{Z}^3
      * @f]
      * 
-     * @todo Need to implement measurement of the average evaluation time for real part of Ewald, this in order to get optimal parametrization to work properly.
      * @warning Current version is constucted such that paramaters can not be correctly updated during a run if splines are used (i.e. only isotropic Coulomb is handled).
      * @warning Ewald summation does not work properly at the moment.
      * 
@@ -227,14 +321,45 @@ namespace Faunus {
 	  typedef typename Tbase::Tgeometry Tgeometry;
 
 	  EwaldParameters<useIonIon,useIonDipole,useDipoleDipole> parameters;
-          int kVectorsInUse, kVectorsInUse_trial, N, cnt_accepted, update_frequency;
-          double V, V_trial, surfaceEnergy, surfaceEnergyTrial, reciprocalEnergy, reciprocalEnergyTrial, eps_surf, const_inf, lB, update_drift; 
+          int N, cnt_accepted, update_frequency;
+          double surfaceEnergyTrial, reciprocalEnergyTrial, eps_surf, const_inf, lB, update_drift; 
           bool spherical_sum, isotropic_pbc;
-          vector<complex<double>> Q_ion_tot, Q_dip_tot, Q_ion_tot_trial, Q_dip_tot_trial;
+          bool tune, tuned;                    // Auto-tuning of alpha, cutoff and cutoffK requested/done
+          double delta, realError, recipError; // Target and estimated accuracy (e^2/Angstrom)
+          string tuneFile;                     // Write tuned parameters to this file (if not empty)
           typename Tspace::Change change;
 
-          Eigen::MatrixXd kVectors, kVectors_trial;  // Matrices with k-vectors
-          Eigen::VectorXd Aks, Aks_trial;  // Stores values based on k-vectors in order to minimize computational effort. (See Eq.24 in DOI: 10.1063/1.481216)
+          /**
+           * @brief Reciprocal space state for one geometry and configuration
+           *
+           * Two of these are kept, see `old()` and `trial()`. Accepting a full
+           * update swaps the buffers instead of copying K long vectors.
+           */
+          struct KState {
+            Eigen::MatrixXd kVectors;                      // Matrix with k-vectors
+            Eigen::Matrix<int,3,Eigen::Dynamic> kIndices;  // Integer lattice vectors, n, of k-vectors
+            Point kUnit;                                   // 2*pi/L such that k = n.cwiseProduct(kUnit)
+            Eigen::VectorXd Aks;                           // Stores values based on k-vectors in order to minimize computational effort. (See Eq.24 in DOI: 10.1063/1.481216)
+            vector<complex<double>> Q_ion, Q_dip;          // Structure factors
+            int kVectorsInUse = 0;
+            double V = 0, surfaceEnergy = 0, reciprocalEnergy = 0;
+          };
+
+          KState buffer[2];
+          int current = 0;
+
+          KState &old() { return buffer[current]; }        //!< Accepted state
+          KState &trial() { return buffer[1-current]; }    //!< Trial state (full updates only)
+
+          /**
+           * Pending trial: `NONE` means trial equals old; `LOCAL` means trial
+           * structure factors are old ones plus `dQ_ion`/`dQ_dip`; `FULL` means
+           * they are found in `trial()`.
+           */
+          enum TrialMode { NONE, LOCAL, FULL } trialMode = NONE;
+          vector<complex<double>> dQ_ion, dQ_dip;          // Structure factor change of local trial move
+
+          mutable vector<complex<double>> eikx, eiky, eikz;  // Per particle exp(i*n*kUnit*r) tables, see 'phaseTables()'
           
           /**
            * @brief Returns Ewald self energy in kT for ions and dipoles.
@@ -294,6 +419,28 @@ namespace Faunus {
             }
             return (2*pc::pi/V_in)*E*lB;
           }
+
+          double getReciprocalEnergy(const KState &s) const {
+            return getReciprocalEnergy(s.Q_ion, s.Q_dip, s.Aks, s.V);
+          }
+
+          /** @brief Reciprocal energy of old structure factors plus `dQ_ion`, `dQ_dip` */
+          double getLocalTrialReciprocalEnergy(const KState &s) const {
+	    double E = 0.0;
+            for (size_t k=0; k < s.Q_ion.size(); k++) {
+              complex<double> qi = s.Q_ion[k] + dQ_ion[k];
+              complex<double> qd = s.Q_dip[k] + dQ_dip[k];
+              double Q2 = 0.0;
+              if(useIonIon)
+                Q2 += std::norm(qi);
+              if(useIonDipole)
+                Q2 += 2.0*std::real(qi*qd);
+              if(useDipoleDipole)
+                Q2 += std::norm(qd);
+              E += ( s.Aks[k] * Q2 );
+            }
+            return (2*pc::pi/s.V)*E*lB;
+          }
           
           /**
            * @brief Returns real space energy in kT.
@@ -308,27 +455,95 @@ namespace Faunus {
 	      return E;
 	    }
 
+          /**
+           * @brief Tabulate exp(i n k_unit r) along x, y and z for n in [-kcc:kcc]
+           *
+           * Each table is built by complex recurrence from a single `polar()` call
+           * so that `eikr()` can assemble exp(ik.r) for any k-vector with two
+           * complex multiplications instead of calling `cos`/`sin`.
+           */
+          void phaseTables(const Point &r, const Point &unit, int kcc) const {
+            vector<complex<double>>* e[3] = {&eikx, &eiky, &eikz};
+            for (int d=0; d<3; d++) {
+              auto &t = *e[d];
+              t.resize(2*kcc+1);
+              t[kcc] = 1.0;
+              if (kcc==0)
+                continue;
+              complex<double> step = std::polar(1.0, unit[d]*r[d]);
+              for (int n=1; n<=kcc; n++) {
+                t[kcc+n] = multiply(t[kcc+n-1], step);
+                t[kcc-n] = std::conj(t[kcc+n]);
+              }
+            }
+          }
+
+          /**
+           * @brief Complex product without the NaN/infinity handling of `std::complex::operator*`
+           *
+           * Without `-ffast-math` the latter is a library call (`__muldc3`) costing as much as `cos`/`sin`.
+           */
+          static complex<double> multiply(const complex<double> &a, const complex<double> &b) {
+            return complex<double>(a.real()*b.real() - a.imag()*b.imag(), a.real()*b.imag() + a.imag()*b.real());
+          }
+
+          /** @brief exp(ik.r) for integer lattice vector `n` from tables made by `phaseTables()` */
+          complex<double> eikr(int nx, int ny, int nz, int kcc) const {
+            return multiply(multiply(eikx[kcc+nx], eiky[kcc+ny]), eikz[kcc+nz]);
+          }
+
+          /**
+           * @brief Add contribution of particle `a` to structure factors
+           * @param sign +1 to add, -1 to subtract
+           * @note Call `phaseTables()` for the particle position first
+           */
+          template<class Tparticle>
+            void addStructureFactor(const Tparticle &a, double sign, vector<complex<double>> &Q_ion_in, vector<complex<double>> &Q_dip_in, const Eigen::MatrixXd &kVectors_in, const Eigen::Matrix<int,3,Eigen::Dynamic> &kIndices_in, int kVectorsInUse_in, int kcc) const {
+              double q = sign*a.charge;
+              for (int k=0; k<kVectorsInUse_in; k++) {
+                int nx = kIndices_in(0,k), ny = kIndices_in(1,k), nz = kIndices_in(2,k);
+                if ( !isotropic_pbc ) {
+                  complex<double> e = eikr(nx, ny, nz, kcc);
+                  if ( useIonIon || useIonDipole )
+                    Q_ion_in[k] += q*e;
+                  if ( useDipoleDipole || useIonDipole )
+                    Q_dip_in[k] += sign*kVectors_in.col(k).dot(a.mu())*a.muscalar()*complex<double>(-e.imag(), e.real());
+                } else {
+                  const complex<double> &ex = eikx[kcc+nx], &ey = eiky[kcc+ny], &ez = eikz[kcc+nz];
+                  if ( useIonIon || useIonDipole )
+                    Q_ion_in[k] += q*ex.real()*ey.real()*ez.real();
+                  if ( useDipoleDipole || useIonDipole ) {
+                    Point kv = kVectors_in.col(k);
+                    Q_dip_in[k] += sign*( ex.imag()*ey.real()*ez.real()*a.mu().x()*kv.x() + ex.real()*ey.imag()*ez.real()*a.mu().y()*kv.y() + ex.real()*ey.real()*ez.imag()*a.mu().z()*kv.z() )*a.muscalar();
+                  }
+                }
+              }
+            }
+
           /**
            * @brief Updates all vectors and matrices which depends on the number of k-space vectors.
            * @note Needs to be called whenever 'kcc_x', 'kcc_y' or 'kcc_z' has been updated
            */
-          void kVectorChange(Eigen::MatrixXd &kVectors_in, Eigen::VectorXd &Aks_in, vector<complex<double>> &Q_ion_tot_in, vector<complex<double>> &Q_dip_tot_in, int &kVectorsInUse_in, EwaldParameters<useIonIon,useIonDipole,useDipoleDipole> &parameters_in) const {
+          void kVectorChange(KState &s, EwaldParameters<useIonIon,useIonDipole,useDipoleDipole> &parameters_in) const {
 	    int kVectorsLength = (2*parameters_in.kcc + 1)*(2*parameters_in.kcc + 1)*(2*parameters_in.kcc + 1) - 1;
+	    s.kUnit = 2*pc::pi*parameters_in.L.cwiseInverse();
 	    if(kVectorsLength == 0) {
-	      kVectors_in.resize(3, 1); 
-	      Aks_in.resize(1);
-	      kVectors_in.col(0) = Point(1.0,0.0,0.0); // Just so it is not the zero-vector
-	      Aks_in[0] = 0.0;
-	      kVectorsInUse_in = 1;
-	      Q_ion_tot_in.resize(1);
-	      Q_dip_tot_in.resize(1);
+	      s.kVectors.resize(3, 1); 
+	      s.kIndices.setZero(3, 1);
+	      s.Aks.resize(1);
+	      s.kVectors.col(0) = Point(1.0,0.0,0.0); // Just so it is not the zero-vector
+	      s.Aks[0] = 0.0;
+	      s.kVectorsInUse = 1;
+	      s.Q_ion.resize(1);
+	      s.Q_dip.resize(1);
 	      return;
 	    }
-            kVectors_in.resize(3, kVectorsLength); 
-            Aks_in.resize(kVectorsLength);
-            kVectorsInUse_in = 0;
-            kVectors_in.setZero();
-            Aks_in.setZero();
+            s.kVectors.resize(3, kVectorsLength); 
+            s.kIndices.resize(3, kVectorsLength);
+            s.Aks.resize(kVectorsLength);
+            s.kVectorsInUse = 0;
+            s.kVectors.setZero();
+            s.Aks.setZero();
 	    int startValue = 1 - int(isotropic_pbc);
 
             double factor = 1.0;
@@ -347,50 +562,152 @@ namespace Faunus {
                   if(spherical_sum)
                     if( (dkx2/parameters_in.kc2) + (dky2/parameters_in.kc2) + (dkz2/parameters_in.kc2) > 1.0)
                       continue;
-                  kVectors_in.col(kVectorsInUse_in) = kv; 
-                  Aks_in[kVectorsInUse_in] = factor*exp(-k2/(4.0*parameters_in.alpha2))/k2;
-                  kVectorsInUse_in++;
+                  s.kVectors.col(s.kVectorsInUse) = kv; 
+                  s.kIndices.col(s.kVectorsInUse) << kx, ky, kz;
+                  s.Aks[s.kVectorsInUse] = factor*exp(-k2/(4.0*parameters_in.alpha2))/k2;
+                  s.kVectorsInUse++;
                 }
               }
             }
-            Q_ion_tot_in.resize(kVectorsInUse_in);
-            Q_dip_tot_in.resize(kVectorsInUse_in);
+            s.Q_ion.resize(s.kVectorsInUse);
+            s.Q_dip.resize(s.kVectorsInUse);
           }
           
           /**
            * @brief Re-calculates the vectors of complex numbers used in getQ2
            * @param p Particle vector
-	   * @param Q_ion_tot_in Vector of complex numbers for ions
-	   * @param Q_dip_tot_in Vector of complex numbers for dipoles
-	   * @param kVectors_in k-vectors
-	   * @param kVectorsInUse_in Number of k-vectors (not necessarily the same as the length of 'kVectors_in')
+	   * @param s State with k-vectors; its structure factors are updated
+           *
+           * Loops over particles and assembles exp(ik.r) from per particle tables, see 'phaseTables()'.
            */
-          void updateAllComplexNumbers(const Tpvec &p, vector<complex<double>> &Q_ion_tot_in, vector<complex<double>> &Q_dip_tot_in, const Eigen::MatrixXd &kVectors_in, int kVectorsInUse_in) const {
-	     for (int k=0; k<kVectorsInUse_in; k++) {
-              Point kv = kVectors_in.col(k);
-              complex<double> Q_temp_ion(0.0,0.0);
-              complex<double> Q_temp_dip(0.0,0.0);
-              for (size_t i = 0; i < p.size(); i++) {
-                double dot = kv.dot(p[i]);
-                if( ( useIonIon || useIonDipole ) && !isotropic_pbc ) {
-                  Q_temp_ion += p[i].charge * complex<double>(cos(dot),sin(dot));
-		} else if( ( useIonIon || useIonDipole ) && isotropic_pbc ) {
-		  Q_temp_ion += p[i].charge*cos(kv.x()*p[i].x())*cos(kv.y()*p[i].y())*cos(kv.z()*p[i].z()); 
-		}
-                if(useDipoleDipole && !isotropic_pbc) {
-                  Q_temp_dip += kv.dot(p[i].mu()) * p[i].muscalar() * complex<double>(-sin(dot),cos(dot));
-		} else if(useDipoleDipole && isotropic_pbc) {
-		  double xx = spc->p[i].x()*kv.x();
-		  double yy = spc->p[i].y()*kv.y();
-		  double zz = spc->p[i].z()*kv.z();
-		  double cosX = cos(xx);
-		  double cosY = cos(yy);
-		  double cosZ = cos(zz);
-		  Q_temp_dip += ( sin(xx)*cosY*cosZ*spc->p[i].mu().x()*kv.x() + cosX*sin(yy)*cosZ*spc->p[i].mu().y()*kv.y() + cosX*cosY*sin(zz)*spc->p[i].mu().z()*kv.z() )*spc->p[i].muscalar();
-		}
+          void updateAllComplexNumbers(const Tpvec &p, KState &s) const {
+            std::fill(s.Q_ion.begin(), s.Q_ion.begin()+s.kVectorsInUse, complex<double>(0.0,0.0));
+            std::fill(s.Q_dip.begin(), s.Q_dip.begin()+s.kVectorsInUse, complex<double>(0.0,0.0));
+            for (size_t i = 0; i < p.size(); i++) {
+              phaseTables(p[i], s.kUnit, parameters.kcc);
+              addStructureFactor(p[i], 1.0, s.Q_ion, s.Q_dip, s.kVectors, s.kIndices, s.kVectorsInUse, parameters.kcc);
+            }
+          }
+
+          /** @brief Sum of squared charges; dipoles enter with the weight they have in the self energy */
+          double chargeSquared(const Tpvec &p, double alpha) const {
+            double Q = 0;
+            for (auto &a : p) {
+              if (useIonIon || useIonDipole)
+                Q += a.charge * a.charge;
+              if (useIonDipole || useDipoleDipole)
+                Q += (2.0/3.0) * alpha * alpha * a.muscalar() * a.muscalar();
+            }
+            return Q;
+          }
+
+          /** @brief Estimated RMS error (e^2/Angstrom) of the real space energy, DOI: 10.1080/08927029208049126 */
+          static double estimateRealError(double Q, double alpha, double rc, double V) {
+            double x2 = alpha*alpha*rc*rc;
+            return Q * sqrt(rc/(2*V)) * exp(-x2) / x2;
+          }
+
+          /**
+           * @brief Estimated error (e^2/Angstrom) of the reciprocal energy for |n| <= K
+           *
+           * RMS error from DOI: 10.1080/08927029208049126 plus the systematic offset from
+           * the omitted k-vectors, which all contribute with |Q(k)|^2 -> Q at large k.
+           */
+          static double estimateReciprocalError(double Q, double alpha, double K, double L) {
+            double x = pc::pi*K/(alpha*L);
+            return Q * alpha / (pc::pi*pc::pi) * pow(K,-1.5) * exp(-x*x) + Q * alpha / sqrt(pc::pi) * erfc(x);
+          }
+
+          /**
+           * @brief Choose `alpha`, `cutoff` and `cutoffK` for accuracy `delta` at the lowest cost
+           *
+           * For a range of real space cut-offs, alpha and the smallest k-space cut-off
+           * meeting `delta` are found from error estimates. Each candidate is then timed
+           * on the current configuration as a single particle move, i.e. real space
+           * energy plus the structure factor update and reciprocal energy, and the
+           * fastest is kept. If `tuneCost` is set it replaces the timing. Needs `spc`
+           * and a geometry.
+           */
+          void tuneParameters() {
+            const Tpvec &p = spc->p;
+            if (p.empty() || chargeSquared(p, 1.0) < 1e-10)
+              return; // nothing to tune for; try again on next 'setSpace()'
+            double V = parameters.L.x() * parameters.L.y() * parameters.L.z();
+            double target = delta / sqrt(2.0); // split error evenly between real and reciprocal space
+            const int candidates = 8, maxK = 40;
+            int nmove = std::min(int(p.size()), 20);
+            double bestTime = pc::infty;
+            auto best = parameters;
+
+            for (int i = 1; i <= candidates; i++) {
+              auto c = parameters;
+              c.rc = 0.5 * c.minL * i / double(candidates);
+
+              // alpha*rc from bisection as the real space error decreases monotonically
+              double lo = 0.1, hi = 10.0;
+              for (int n = 0; n < 60; n++) {
+                double x = 0.5 * (lo + hi);
+                if (estimateRealError(chargeSquared(p, x/c.rc), x/c.rc, c.rc, V) > target)
+                  lo = x;
+                else
+                  hi = x;
+              }
+              c.alpha = hi / c.rc;
+              c.alpha2 = c.alpha * c.alpha;
+
+              double Q = chargeSquared(p, c.alpha);
+              int K = 1;
+              while (K <= maxK && estimateReciprocalError(Q, c.alpha, K, c.maxL) > target)
+                K++;
+              if (K > maxK)
+                continue;
+              c.kc = K;
+              c.kc2 = c.kc * c.kc;
+              c.kcc = K;
+
+              parameters = c;
+              Tbase::pairpot.first.updateRcut(c.rc);
+              Tbase::pairpot.first.updateAlpha(c.alpha);
+              KState &s = trial(); // used as scratch; no trial move is pending
+              kVectorChange(s, parameters);
+              std::fill(s.Q_ion.begin(), s.Q_ion.end(), complex<double>(0.0,0.0));
+              std::fill(s.Q_dip.begin(), s.Q_dip.end(), complex<double>(0.0,0.0));
+              s.V = V;
+
+              double time;
+              if (tuneCost)
+                time = tuneCost(c.alpha, c.rc, s.kVectorsInUse);
+              else {
+                volatile double u = 0; // keeps timed work from being optimized away
+                auto t0 = std::chrono::steady_clock::now();
+                for (int j = 0; j < nmove; j++) {
+                  u += Tbase::i2all(spc->p, j);
+                  phaseTables(p[j], s.kUnit, c.kcc);
+                  addStructureFactor(p[j], 1.0, s.Q_ion, s.Q_dip, s.kVectors, s.kIndices, s.kVectorsInUse, c.kcc);
+                  addStructureFactor(p[j], -1.0, s.Q_ion, s.Q_dip, s.kVectors, s.kIndices, s.kVectorsInUse, c.kcc);
+                  u += getReciprocalEnergy(s);
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                time = std::chrono::duration<double>(t1 - t0).count();
+              }
+              if (time < bestTime) {
+                bestTime = time;
+                best = c;
+                realError = estimateRealError(Q, c.alpha, c.rc, V);
+                recipError = estimateReciprocalError(Q, c.alpha, K, c.maxL);
               }
-              Q_ion_tot_in.at(k) = Q_temp_ion;
-              Q_dip_tot_in.at(k) = Q_temp_dip;
+            }
+            if (bestTime == pc::infty)
+              throw std::runtime_error("Ewald: tuning cannot reach requested accuracy 'delta'");
+
+            parameters = best;
+            Tbase::pairpot.first.updateRcut(parameters.rc);
+            Tbase::pairpot.first.updateAlpha(parameters.alpha);
+            tuned = true;
+            if (!tuneFile.empty()) {
+              std::ofstream f(tuneFile);
+              if (f)
+                f << std::setw(4) << json() << endl;
             }
           }
 
@@ -444,7 +761,7 @@ namespace Faunus {
 	    if(parameters.kcc == 0 && parameters.kcc == 0 && parameters.kcc == 0) {
 	      o << pad(SUB,w, "Wavefunctions") << 0 << endl;
 	    } else {
-	      o << pad(SUB,w, "Wavefunctions") << kVectorsInUse << " (" << realKvectors << ")" << endl;
+	      o << pad(SUB,w, "Wavefunctions") << buffer[current].kVectorsInUse << " (" << realKvectors << ")" << endl;
 	    }
             o << pad(SUB,w, "alpha") << parameters.alpha << endl;
             o << pad(SUB,w, "Real cut-off") << parameters.rc << endl;
@@ -454,6 +771,11 @@ namespace Faunus {
               o << pad(SUB,w+1, epsilon_m+"(Surface)") << eps_surf << endl;
             }
 	    o << pad(SUB,w, "Drift") << update_drift << endl;
+	    if(tuned) {
+	      o << pad(SUB,w, "Tuned for accuracy") << delta << " e"+squared+"/"+angstrom << endl;
+	      o << pad(SUB,w, "    Est. real error") << realError << endl;
+	      o << pad(SUB,w, "    Est. reci error") << recipError << endl;
+	    }
 	    
             o << pad(SUB,w+4, bracket("Energies / kT")) << endl;
             o << pad(SUB,w+4, bracket("Self energy")) << selfEnergyAverage.avg() << endl;
@@ -473,6 +795,14 @@ namespace Faunus {
         public:
           MeanValue<double> selfEnergyAverage, surfaceEnergyAverage, realEnergyAverage, reciprocalEnergyAverage;
 
+          /**
+           * @brief Cost of a tuning candidate given `alpha`, `cutoff` and number of k-vectors in use
+           *
+           * Replaces timing in `tuneParameters()` if set, e.g. by keyword `tune_cost`,
+           * which makes the tuned parameters reproducible. Set before the first `setSpace()`.
+           */
+          std::function<double(double,double,int)> tuneCost;
+
           NonbondedEwald(Tmjson &j, const string &sec="nonbonded") : Tbase(j,sec) , selfEnergyAverage(j["energy"]["nonbonded"]["avg_block"] | 100) ,surfaceEnergyAverage(j["energy"]["nonbonded"]["avg_block"] | 100) , realEnergyAverage(j["energy"]["nonbonded"]["avg_block"] | 100) , reciprocalEnergyAverage(j["energy"]["nonbonded"]["avg_block"] | 100)  {
 	    Tbase::name += " (Ewald)";
             auto _j = j["energy"]["nonbonded"]["ewald"];
@@ -483,56 +813,75 @@ namespace Faunus {
             const_inf = (eps_surf < 1) ? 0.0 : 1.0;                 // if the value is unphysical (< 1) then we set infinity as the dielectric sonatant of the surronding medium
             spherical_sum = ( _j.value("spherical_sum",true) );     // specifies if Spherical or Cubical summation should be used in reciprocal space
 	    update_frequency = ( _j.value("update_frequency",-1) );
-	    parameters.alpha = ( _j.at("alpha") );
+            tune = ( _j.value("tune",false) );
+            tuned = false;
+            delta = ( _j.value("delta",5e-5) );
+            tuneFile = ( _j.value("tune_file",string()) );
+            if (_j.value("tune_cost",string("timing")) == "estimate")
+              tuneCost = [this](double alpha, double rc, int nk) { // pairs within cutoff plus k-vectors per particle
+                double V = parameters.L.x() * parameters.L.y() * parameters.L.z();
+                return spc->p.size() * 4*pc::pi/3 * rc*rc*rc / V + nk;
+              };
+            realError = recipError = 0;
+            if(tune) { // placeholders until tuned in 'setSpace()'
+              parameters.alpha = ( _j.value("alpha",0.5) );
+              parameters.rc = ( _j.value("cutoff",1.0) );
+              parameters.kc = ( _j.value("cutoffK",1.0) );
+            } else {
+              parameters.alpha = ( _j.at("alpha") );
+              parameters.rc = ( _j.at("cutoff") );
+              parameters.kc = ( _j.at("cutoffK") );
+            }
 	    parameters.alpha2 = parameters.alpha*parameters.alpha;
-	    parameters.rc = ( _j.at("cutoff") );
-	    parameters.kc = ( _j.at("cutoffK") );
             parameters.kc2 = parameters.kc*parameters.kc;
             parameters.kcc = ceil(parameters.kc);
             isotropic_pbc = ( _j.value("isotropic_pbc",false) );
 	    Tbase::pairpot.first.updateRcut(parameters.rc);
             Tbase::pairpot.first.updateAlpha(parameters.alpha);
-	    kVectorChange(kVectors,Aks,Q_ion_tot,Q_dip_tot,kVectorsInUse,parameters);
+	    kVectorChange(old(),parameters);
+          }
+
+          /**
+           * @brief Current `alpha`, `cutoff` and `cutoffK` in input format
+           *
+           * After tuning this can be merged into the input of later runs.
+           */
+          Tmjson json() const {
+            Tmjson j;
+            auto &_j = j["energy"]["nonbonded"]["ewald"];
+            _j["alpha"] = parameters.alpha;
+            _j["cutoff"] = parameters.rc;
+            _j["cutoffK"] = parameters.kc;
+            if (tuned)
+              _j["delta"] = delta;
+            return j;
           }
           
           /**
-	   * @brief Replaces all trial-entities with the old ones
+	   * @brief Discards trial-entities; the trial state equals the old one
 	   */
           void undo() {
-	    V_trial = V;
-	    kVectorsInUse_trial = kVectorsInUse;
-	    surfaceEnergyTrial = surfaceEnergy;
-	    reciprocalEnergyTrial = reciprocalEnergy;
-            Q_ion_tot_trial.resize(kVectorsInUse);
-            Q_dip_tot_trial.resize(kVectorsInUse);
-            kVectors_trial.resize(3, kVectorsInUse); 
-	    Aks_trial.resize(kVectorsInUse); 
-            for (int k=0; k < kVectorsInUse; k++) {
-              Q_ion_tot_trial.at(k) = Q_ion_tot.at(k);
-              Q_dip_tot_trial.at(k) = Q_dip_tot.at(k);
-              kVectors_trial.col(k) = kVectors.col(k);
-              Aks_trial[k] = Aks[k];
-            }
+	    trialMode = NONE;
 	  }
 	  
           /**
-	   * @brief Replaces all old-entities with the trial ones
+	   * @brief Makes the trial-entities the old ones
+	   *
+	   * Full updates swap buffers; local updates add the structure factor change in place.
 	   */
           void accept() {
-	    V = V_trial;
-	    kVectorsInUse = kVectorsInUse_trial;
-	    surfaceEnergy = surfaceEnergyTrial;
-	    reciprocalEnergy = reciprocalEnergyTrial;
-            Q_ion_tot.resize(kVectorsInUse);
-            Q_dip_tot.resize(kVectorsInUse);
-            kVectors.resize(3, kVectorsInUse);
-	    Aks.resize(kVectorsInUse); 
-            for (int k=0; k < kVectorsInUse; k++) {
-              Q_ion_tot.at(k) = Q_ion_tot_trial.at(k);
-              Q_dip_tot.at(k) = Q_dip_tot_trial.at(k);
-              kVectors.col(k) = kVectors_trial.col(k);
-              Aks[k] = Aks_trial[k];
+            if (trialMode == FULL)
+              current = 1-current;
+            else if (trialMode == LOCAL)
+              for (int k=0; k < old().kVectorsInUse; k++) {
+                old().Q_ion[k] += dQ_ion[k];
+                old().Q_dip[k] += dQ_dip[k];
+              }
+            if (trialMode != NONE) {
+              old().surfaceEnergy = surfaceEnergyTrial;
+              old().reciprocalEnergy = reciprocalEnergyTrial;
             }
+            trialMode = NONE;
 	  }
 
           /**
@@ -540,7 +889,6 @@ namespace Faunus {
            * After 'update_frequency' number of non-isobaric updates the entirety of the complex vectors are recalculated in order to avoid numerical errors.
            * @param move_accepted True if a move is accepted, otherwise false
            * 
-           * @note Needs to be called before particle-vectors are updated after acception/rejection.
 	   * @note Assumes energy and trial-energy has been calculated consecutively
            */
           double update(bool move_accepted) override {
@@ -550,90 +898,67 @@ namespace Faunus {
 	      undo();
 	      Group g(0, spc->p.size()-1);
 	      selfEnergyAverage += getSelfEnergy(spc->p,g,parameters);
-	      surfaceEnergyAverage += surfaceEnergy;
-	      reciprocalEnergyAverage += reciprocalEnergy;
+	      surfaceEnergyAverage += old().surfaceEnergy;
+	      reciprocalEnergyAverage += old().reciprocalEnergy;
 	      //realEnergyAverage += getRealEnergy(spc->p); // Takes a lot of time
 	      change.clear();
               return 0.0;
 	    }
 	    // Move has been accepted
+	    accept();
 	    Group g(0, spc->trial.size()-1);
 	    selfEnergyAverage += getSelfEnergy(spc->trial,g,parameters);
-	    surfaceEnergyAverage += surfaceEnergy;
-	    reciprocalEnergyAverage += reciprocalEnergy;
+	    surfaceEnergyAverage += old().surfaceEnergy;
+	    reciprocalEnergyAverage += old().reciprocalEnergy;
 	    //realEnergyAverage += getRealEnergy(spc->trial); // Takes a lot of time
 	    
 	    if(++cnt_accepted > update_frequency - 1) {
-	      double duB = getReciprocalEnergy(Q_ion_tot_trial,Q_dip_tot_trial,Aks_trial,V_trial);                        // Calulate with old vectors/matrices
-	      updateAllComplexNumbers(spc->trial, Q_ion_tot_trial, Q_dip_tot_trial, kVectors_trial, kVectorsInUse_trial); // Re-calculate the vectors/matrices
-	      double duA = getReciprocalEnergy(Q_ion_tot_trial,Q_dip_tot_trial,Aks_trial,V_trial);                        // Calulate with new vectors/matrices
-	      accept(); 
+	      double duB = getReciprocalEnergy(old());             // Calulate with old vectors/matrices
+	      updateAllComplexNumbers(spc->trial, old());          // Re-calculate the vectors/matrices
+	      double duA = getReciprocalEnergy(old());             // Calulate with new vectors/matrices
+	      old().reciprocalEnergy = duA;
 	      cnt_accepted = 0;
 	      update_drift += fabs(duA - duB);
 	      change.clear();
 	      return (duA - duB);
 	    }
-	    accept();
 	    change.clear();
 	    return 0.0;
           }
 
-          /** @brief Update energy function due to Change. 
+          /**
+           * @brief Update energy function due to Change. 
+           *
+           * Volume changes fill `trial()` with new k-vectors and structure factors.
+           * Otherwise only the change in structure factors due to the moved particles
+           * is stored so that neither rejection nor acceptance involve copying.
 	   *  @warning Need to update parameters in pairpot.
            */
           double updateChange(const typename Tspace::Change &c) override {
             change = c;
 
             if(c.geometryChange) {
-              updateAllComplexNumbers(spc->trial, Q_ion_tot_trial, Q_dip_tot_trial,kVectors_trial,kVectorsInUse_trial);
-              V_trial = V + c.dV;
 	      parameters.update(spc->geo_trial.len);
+	      kVectorChange(trial(),parameters);
+              updateAllComplexNumbers(spc->trial, trial());
+              trial().V = old().V + c.dV;
+              trialMode = FULL;
               return 0.0;
             }
 
-            // If the volume has not changed
-            for (int k=0; k<kVectorsInUse_trial; k++) {
-              complex<double> Q2_ion = Q_ion_tot.at(k);
-              complex<double> Q2_dip = Q_dip_tot.at(k);
-              for (auto m : change.mvGroup) {
-                for (auto i : m.second) {
-                  double dotTrial = kVectors_trial.col(k).dot(spc->trial[i]);
-                  double dot = kVectors.col(k).dot(spc->p[i]);
-                  if ( ( useIonIon || useIonDipole ) && !isotropic_pbc ) {
-                    Q2_ion += spc->trial[i].charge * complex<double>(cos(dotTrial),sin(dotTrial));
-                    Q2_ion -= spc->p[i].charge * complex<double>(cos(dot),sin(dot));
-                  } else if( ( useIonIon || useIonDipole ) && isotropic_pbc ) {
-		    Point kv = kVectors_trial.col(k);
-		    Q2_ion += spc->trial[i].charge*cos(kv.x()*spc->trial[i].x())*cos(kv.y()*spc->trial[i].y())*cos(kv.z()*spc->trial[i].z()); 
-		    kv = kVectors.col(k);
-		    Q2_ion -= spc->p[i].charge*cos(kv.x()*spc->p[i].x())*cos(kv.y()*spc->p[i].y())*cos(kv.z()*spc->p[i].z()); 
-		  }
-                  if ( ( useDipoleDipole || useIonDipole ) && !isotropic_pbc ) {
-                    Q2_dip += kVectors_trial.col(k).dot(spc->trial[i].mu()) * spc->trial[i].muscalar() * complex<double>(-sin(dotTrial),cos(dotTrial));
-                    Q2_dip -= kVectors.col(k).dot(spc->p[i].mu()) * spc->p[i].muscalar() * complex<double>(-sin(dot),cos(dot));
-                  } else if ( ( useDipoleDipole || useIonDipole ) && isotropic_pbc ) {
-		    Point kv = kVectors_trial.col(k);
-		    double xx = spc->trial[i].x()*kv.x();
-		    double yy = spc->trial[i].y()*kv.y();
-		    double zz = spc->trial[i].z()*kv.z();
-		    double cosX = cos(xx);
-		    double cosY = cos(yy);
-		    double cosZ = cos(zz);
-		    Q2_dip += ( sin(xx)*cosY*cosZ*spc->trial[i].mu().x()*kv.x() + cosX*sin(yy)*cosZ*spc->trial[i].mu().y()*kv.y() + cosX*cosY*sin(zz)*spc->trial[i].mu().z()*kv.z() )*spc->trial[i].muscalar();
-		    kv = kVectors.col(k);
-		    xx = spc->p[i].x()*kv.x();
-		    yy = spc->p[i].y()*kv.y();
-		    zz = spc->p[i].z()*kv.z();
-		    cosX = cos(xx);
-		    cosY = cos(yy);
-		    cosZ = cos(zz);
-		    Q2_dip -= ( sin(xx)*cosY*cosZ*spc->p[i].mu().x()*kv.x() + cosX*sin(yy)*cosZ*spc->p[i].mu().y()*kv.y() + cosX*cosY*sin(zz)*spc->p[i].mu().z()*kv.z() )*spc->p[i].muscalar();
-                  }
-                }
+            // If the volume has not changed: add trial and subtract old contributions of moved particles
+            KState &s = old();
+            dQ_ion.assign(s.kVectorsInUse, complex<double>(0.0,0.0));
+            dQ_dip.assign(s.kVectorsInUse, complex<double>(0.0,0.0));
+            for (auto &m : change.mvGroup) {
+              for (auto i : m.second) {
+                phaseTables(spc->trial[i], s.kUnit, parameters.kcc);
+                addStructureFactor(spc->trial[i], 1.0, dQ_ion, dQ_dip, s.kVectors, s.kIndices, s.kVectorsInUse, parameters.kcc);
+                phaseTables(spc->p[i], s.kUnit, parameters.kcc);
+                addStructureFactor(spc->p[i], -1.0, dQ_ion, dQ_dip, s.kVectors, s.kIndices, s.kVectorsInUse, parameters.kcc);
               }
-              Q_ion_tot_trial.at(k) = Q2_ion;
-              Q_dip_tot_trial.at(k) = Q2_dip;
             }
+            trialMode = LOCAL;
             return 0.0;
           }
           
@@ -646,32 +971,46 @@ namespace Faunus {
 	    return getSelfEnergy(p,g,parameters);
           }
 
+          bool isReentrant() override { return false; } // k-space states and tuning are updated on demand
+
           double external(const Tpvec &p) override {
             Group g(0, p.size()-1);
-	    double total = 0.0;
             if (Tbase::isTrial(p)) {
-              surfaceEnergyTrial = getSurfaceEnergy(p,g,V_trial);
-              reciprocalEnergyTrial = getReciprocalEnergy(Q_ion_tot_trial,Q_dip_tot_trial,Aks_trial,V_trial);
-	      total = surfaceEnergyTrial + reciprocalEnergyTrial;
-            } else {
-              surfaceEnergy = getSurfaceEnergy(p,g,V);
-              reciprocalEnergy = getReciprocalEnergy(Q_ion_tot,Q_dip_tot,Aks,V);
-	      total = surfaceEnergy + reciprocalEnergy;
+              if (trialMode == FULL) {
+                surfaceEnergyTrial = getSurfaceEnergy(p,g,trial().V);
+                reciprocalEnergyTrial = getReciprocalEnergy(trial());
+              } else {
+                surfaceEnergyTrial = getSurfaceEnergy(p,g,old().V);
+                reciprocalEnergyTrial = (trialMode == LOCAL) ? getLocalTrialReciprocalEnergy(old()) : getReciprocalEnergy(old());
+              }
+              return surfaceEnergyTrial + reciprocalEnergyTrial;
             }
-            return total;
+            old().surfaceEnergy = getSurfaceEnergy(p,g,old().V);
+            old().reciprocalEnergy = getReciprocalEnergy(old());
+            return old().surfaceEnergy + old().reciprocalEnergy;
           }
     
+          /**
+           * @brief Set geometry and rebuild k-vectors and structure factors
+           *
+           * Ignored while a trial move is pending, i.e. when called by
+           * `Energy::energyChange` or `Move::Isobaric` between
+           * `updateChange()` and `update()`.
+           */
           void setGeometry(typename Tspace::GeometryType &g) override {
             Tbase::setGeometry(g);
 	    parameters.update(g.len);
+	    if(trialMode != NONE)
+	      return;
 	    if(Tbase::isGeometryTrial(g)) {
-	      V_trial = g.getVolume();
-	      kVectorChange(kVectors_trial,Aks_trial,Q_ion_tot_trial,Q_dip_tot_trial,kVectorsInUse_trial,parameters);
-	      updateAllComplexNumbers(spc->trial,Q_ion_tot_trial,Q_dip_tot_trial,kVectors_trial,kVectorsInUse_trial);
+	      trial().V = g.getVolume();
+	      kVectorChange(trial(),parameters);
+	      updateAllComplexNumbers(spc->trial,trial());
+	      trialMode = FULL;
 	    } else {
-	      V = g.getVolume();
-	      kVectorChange(kVectors,Aks,Q_ion_tot,Q_dip_tot,kVectorsInUse,parameters);
-	      updateAllComplexNumbers(spc->p,Q_ion_tot,Q_dip_tot,kVectors,kVectorsInUse);
+	      old().V = g.getVolume();
+	      kVectorChange(old(),parameters);
+	      updateAllComplexNumbers(spc->p,old());
 	    }
 	  }
 	  
@@ -681,14 +1020,520 @@ namespace Faunus {
           void setSpace(Tspace &s) override {
             Tbase::setSpace(s);
             N = s.p.size();
+            if(trialMode != NONE)
+              return;
+            if(tune && !tuned) {
+              tuneParameters();
+              kVectorChange(old(),parameters);
+              updateAllComplexNumbers(s.p,old());
+            }
 	    Group g(0, N-1);
-	    surfaceEnergy = getSurfaceEnergy(s.p,g,V);
-	    reciprocalEnergy = getReciprocalEnergy(Q_ion_tot,Q_dip_tot,Aks,V);
-	    undo(); // initialization of trial-entities
-            //change.clear();
+	    old().surfaceEnergy = getSurfaceEnergy(s.p,g,old().V);
+	    old().reciprocalEnergy = getReciprocalEnergy(old());
           }
       };
 
+
+    /**
+     * @brief Smooth particle-mesh Ewald (SPME) summation for ions
+     *
+     * Alternative to `NonbondedEwald` for large systems where the number of
+     * k-vectors grows with the volume. Charges are spread onto a regular
+     * grid with cardinal B-splines and the reciprocal energy is evaluated by
+     * `FFT3D` (Essmann et al., DOI: 10.1063/1.470117):
+     *
+     * @f[
+     * E_{Reciprocal} = \sum_{{\bf m} \ne {\bf 0}} G({\bf m}) \left|\mathcal{F}[Q]({\bf m})\right|^2 \;\;,\;\;
+     * G({\bf m}) = \frac{2\pi}{V}\frac{e^{-k^2/4\alpha^2}}{k^2}B({\bf m})
+     * @f]
+     *
+     * Writing the energy as @f$ E = Q\cdot\phi @f$ with @f$ \phi = \theta\star Q @f$ and
+     * @f$ \theta = \mathcal{F}^{-1}[G] @f$, local moves changing the grid by the
+     * B-spline stencils @f$ \delta @f$ of the moved particles are evaluated
+     * without FFT as
+     *
+     * @f[
+     * \Delta E = 2\delta\cdot\phi + \delta\cdot(\theta\star\delta)
+     * @f]
+     *
+     * Accepted stencils are added to the charge grid and kept in a list until
+     * @f$ \phi @f$ is refreshed by FFT, which is done once evaluating the list
+     * costs more than a transform. Volume moves, insertions/deletions and moves
+     * of many particles update the full grid. Real space, self and surface
+     * terms are as in `NonbondedEwald`.
+     *
+     * Keywords are read from `energy/nonbonded/ewald`:
+     *
+     *  Keyword          |  Description
+     * :--------------   | :---------------
+     * `alpha`           |  Damping parameter (1/Å)
+     * `cutoff`          |  Real space cut-off (Å)
+     * `eps_surf`        |  Dielectric constant of the surroundings. Values <1 means tinfoil. (Default: 0)
+     * `order`           |  B-spline interpolation order. (Default: 4)
+     * `spacing`         |  Approximate grid spacing (Å); rounded to a power of two number of points. (Default: 1)
+     * `grid`            |  Number of grid points per dimension; overrides `spacing`. Rounded up to a power of two.
+     * `tolerance`       |  Max. deviation (kT) of the initial reciprocal energy from direct Ewald summation with `cutoffK`. The grid is refined until met. (Default: 0 = no check)
+     * `cutoffK`         |  Spherical k-space cut-off for the `tolerance` check, as in `NonbondedEwald`
+     *
+     * @note Ion-ion interactions only; requires a cuboidal geometry.
+     */
+    template<class Tspace, class Tpairpot,
+      class Tbase=NonbondedVector<Tspace, CombinedPairPotential<EwaldReal<true,false,false>, Tpairpot>>>
+      class NonbondedSPME : public Tbase {
+        private:
+          using Tbase::spc;
+          typedef typename Tbase::Tpvec Tpvec;
+          typedef std::complex<double> Tcomplex;
+
+          static const int maxOrder = 12;
+
+          /** @brief B-spline weights of a single charge on the grid */
+          struct Stencil {
+            int start[3];                // first grid point along each dimension
+            double q;                    // charge
+            double w[3][maxOrder];       // weights along each dimension
+          };
+
+          int order, K[3], gridInput, cntLocal, cntFull, cntRefresh;
+          size_t N, maxPending;
+          double alpha, lB, eps_surf, spacing, tolerance, kc, drift, toleranceError;
+          double V, V_trial, reciprocalEnergy, reciprocalEnergyTrial, surfaceEnergy, surfaceEnergyTrial;
+          bool initialized, trialPending, trialFull, trialGeometry;
+          Point L, L_trial, qr, qr_trial;      // box lengths; sum of q*r for surface energy
+
+          FFT3D fft;
+          std::vector<double> G, G_trial;      // reciprocal influence function
+          std::vector<double> theta;           // real space influence function, inverse transform of G
+          std::vector<double> Q, Q_trial;      // charge grids
+          std::vector<double> phi;             // theta convolved with Q, excluding pending stencils
+          std::vector<Tcomplex> F, F_trial;    // transformed charge grids
+          std::vector<Stencil> pending;        // accepted stencils not yet in phi
+          std::vector<Stencil> delta;          // stencils of current trial move
+
+          /** @brief Cardinal B-spline weights, t[i] = M_n(w+n-1-i) */
+          void bspline(double w, double *t) const {
+            t[order-1]=0;
+            t[1]=w;
+            t[0]=1-w;
+            for (int k=3; k<=order; k++) {
+              double div = 1.0/(k-1);
+              t[k-1] = div*w*t[k-2];
+              for (int j=1; j<=k-2; j++)
+                t[k-j-1] = div*((w+j)*t[k-j-2] + (k-j-w)*t[k-j-1]);
+              t[0] = div*(1-w)*t[0];
+            }
+          }
+
+          void fillStencil(Stencil &s, const Point &r, double q, const Point &len) const {
+            s.q = q;
+            for (int d=0; d<3; d++) {
+              double u = K[d]*(r[d]/len[d] + 0.5);
+              u -= K[d]*std::floor(u/K[d]);
+              int fl = int(std::floor(u));
+              bspline(u-fl, s.w[d]);
+              s.start[d] = ((fl-order+1) % K[d] + K[d]) % K[d];
+            }
+          }
+
+          /** @brief Call `f(index, q*weight)` for all grid points of stencil */
+          template<class Tfunc>
+            void forEachPoint(const Stencil &s, Tfunc f) const {
+              for (int i=0; i<order; i++) {
+                int x = (s.start[0]+i) % K[0];
+                for (int j=0; j<order; j++) {
+                  int y = (s.start[1]+j) % K[1];
+                  int base = (x*K[1]+y)*K[2];
+                  double wxy = s.q*s.w[0][i]*s.w[1][j];
+                  for (int k=0; k<order; k++)
+                    f(base + (s.start[2]+k) % K[2], wxy*s.w[2][k]);
+                }
+              }
+            }
+
+          double dot(const std::vector<double> &grid, const Stencil &s) const {
+            double sum=0;
+            forEachPoint(s, [&](int i, double v) { sum += grid[i]*v; });
+            return sum;
+          }
+
+          /** @brief Interaction between two stencils through theta */
+          double convolve(const Stencil &a, const Stencil &b) const {
+            int dx[maxOrder*maxOrder], dy[maxOrder*maxOrder], dz[maxOrder*maxOrder];
+            int *dd[3] = {dx,dy,dz};
+            for (int d=0; d<3; d++)
+              for (int i=0; i<order; i++)
+                for (int l=0; l<order; l++) {
+                  int v = (a.start[d]+i-b.start[d]-l) % K[d];
+                  dd[d][i*order+l] = (v<0) ? v+K[d] : v;
+                }
+            double sum=0;
+            for (int i=0; i<order; i++)
+              for (int l=0; l<order; l++) {
+                double wx = a.w[0][i]*b.w[0][l];
+                int bx = dx[i*order+l]*K[1];
+                for (int j=0; j<order; j++)
+                  for (int m=0; m<order; m++) {
+                    double wxy = wx*a.w[1][j]*b.w[1][m];
+                    const double *t = &theta[(bx+dy[j*order+m])*K[2]];
+                    const int *tz = dz;
+                    for (int k=0; k<order; k++, tz+=order) {
+                      double u=0;
+                      for (int n=0; n<order; n++)
+                        u += b.w[2][n]*t[tz[n]];
+                      sum += wxy*a.w[2][k]*u;
+                    }
+                  }
+              }
+            return a.q*b.q*sum;
+          }
+
+          /** @brief Reciprocal influence function, G(m), for box lengths `len` */
+          void influence(std::vector<double> &g, const Point &len) const {
+            double t[maxOrder];
+            bspline(0, t);
+            std::vector<double> b2[3]; // 1/|b(m)|^2
+            for (int d=0; d<3; d++) {
+              b2[d].resize(K[d]);
+              for (int m=0; m<K[d]; m++) {
+                Tcomplex sum(0,0);
+                for (int k=0; k<=order-2; k++)
+                  sum += t[order-2-k]*std::polar(1.0, 2*pc::pi*m*k/K[d]);
+                b2[d][m] = std::norm(sum);
+              }
+              for (int m=0; m<K[d]; m++) // zeros for odd orders; interpolate
+                if (b2[d][m] < 1e-7)
+                  b2[d][m] = 0.5*(b2[d][(m+K[d]-1)%K[d]] + b2[d][(m+1)%K[d]]);
+              for (auto &b : b2[d])
+                b = 1/b;
+            }
+            double vol = len.x()*len.y()*len.z();
+            g.resize(fft.size());
+            for (int x=0; x<K[0]; x++) {
+              double kx = 2*pc::pi*((x<K[0]/2) ? x : x-K[0])/len.x();
+              for (int y=0; y<K[1]; y++) {
+                double ky = 2*pc::pi*((y<K[1]/2) ? y : y-K[1])/len.y();
+                for (int z=0; z<K[2]; z++) {
+                  double kz = 2*pc::pi*((z<K[2]/2) ? z : z-K[2])/len.z();
+                  double k2 = kx*kx + ky*ky + kz*kz;
+                  int i = (x*K[1]+y)*K[2]+z;
+                  g[i] = (i==0) ? 0 : lB*2*pc::pi/vol*std::exp(-k2/(4*alpha*alpha))/k2*b2[0][x]*b2[1][y]*b2[2][z];
+                }
+              }
+            }
+          }
+
+          /** @brief Update theta from G */
+          void realSpaceInfluence() {
+            F.assign(G.begin(), G.end());
+            fft.backward(F);
+            theta.resize(F.size());
+            for (size_t i=0; i<F.size(); i++)
+              theta[i] = F[i].real();
+          }
+
+          void chargeGrid(const Tpvec &p, const Point &len, std::vector<double> &grid) const {
+            grid.assign(fft.size(), 0);
+            Stencil s;
+            for (auto &a : p)
+              if (a.charge != 0) {
+                fillStencil(s, a, a.charge, len);
+                forEachPoint(s, [&](int i, double v) { grid[i] += v; });
+              }
+          }
+
+          /** @brief Reciprocal energy of charge grid; `f` is left with its transform */
+          double gridEnergy(const std::vector<double> &grid, const std::vector<double> &g, std::vector<Tcomplex> &f) {
+            f.assign(grid.begin(), grid.end());
+            fft.forward(f);
+            double E=0;
+            for (size_t i=0; i<f.size(); i++)
+              E += g[i]*std::norm(f[i]);
+            return E;
+          }
+
+          /** @brief Update phi from transformed charge grid (destroys `f`) */
+          void gridPotential(std::vector<Tcomplex> &f, const std::vector<double> &g) {
+            for (size_t i=0; i<f.size(); i++)
+              f[i] *= g[i];
+            fft.backward(f);
+            phi.resize(f.size());
+            for (size_t i=0; i<f.size(); i++)
+              phi[i] = f[i].real();
+          }
+
+          /** @brief Reciprocal energy by direct Ewald summation, for validation */
+          double directEnergy(const Tpvec &p, const Point &len) const {
+            int kcc = std::ceil(kc);
+            double E=0, vol=len.x()*len.y()*len.z();
+            for (int nx=-kcc; nx<=kcc; nx++)
+              for (int ny=-kcc; ny<=kcc; ny++)
+                for (int nz=-kcc; nz<=kcc; nz++) {
+                  int n2 = nx*nx + ny*ny + nz*nz;
+                  if (n2==0 || n2 > kc*kc)
+                    continue;
+                  Point kv = 2*pc::pi*Point(nx/len.x(), ny/len.y(), nz/len.z());
+                  double k2 = kv.squaredNorm();
+                  Tcomplex S(0,0);
+                  for (auto &a : p)
+                    S += a.charge*std::polar(1.0, kv.dot(a));
+                  E += std::exp(-k2/(4*alpha*alpha))/k2*std::norm(S);
+                }
+            return lB*2*pc::pi/vol*E;
+          }
+
+          Point chargeDipole(const Tpvec &p) const {
+            Point m(0,0,0);
+            for (auto &a : p)
+              m += a.charge*a;
+            return m;
+          }
+
+          double getSurfaceEnergy(const Point &m, double vol) const {
+            if (eps_surf < 1)
+              return 0;
+            return 2*pc::pi/((2*eps_surf+1)*vol)*m.squaredNorm()*lB;
+          }
+
+          /** @brief Set up grid and all energies from `spc->p` */
+          void init() {
+            L = spc->geo.len;
+            V = L.x()*L.y()*L.z();
+            N = spc->p.size();
+            for (int d=0; d<3; d++) {
+              K[d] = (gridInput>0) ? gridInput : int(std::ceil(L[d]/spacing));
+              K[d] = FFT3D::nextPowerOfTwo(std::max(K[d], order));
+            }
+            double Eref = (tolerance>0) ? directEnergy(spc->p, L) : 0;
+            while (true) {
+              fft.resize(K[0],K[1],K[2]);
+              influence(G, L);
+              chargeGrid(spc->p, L, Q);
+              reciprocalEnergy = gridEnergy(Q, G, F);
+              toleranceError = std::fabs(reciprocalEnergy-Eref);
+              if (tolerance<=0 || toleranceError<=tolerance)
+                break;
+              if (fft.size() >= (size_t(1)<<24))
+                throw std::runtime_error("SPME: grid refinement cannot reach requested tolerance");
+              for (auto &k : K)
+                k*=2;
+            }
+            gridPotential(F, G);
+            realSpaceInfluence();
+            size_t M = fft.size();
+            maxPending = std::max(size_t(1), size_t(M*std::log2(double(M))/std::pow(order,6)));
+            pending.clear();
+            delta.clear();
+            qr = chargeDipole(spc->p);
+            surfaceEnergy = getSurfaceEnergy(qr, V);
+            trialPending = false;
+            initialized = true;
+          }
+
+          /** @brief Trial energy by updating the full grid */
+          void fullTrial(const Point &len) {
+            L_trial = len;
+            V_trial = len.x()*len.y()*len.z();
+            if (trialGeometry)
+              influence(G_trial, L_trial);
+            chargeGrid(spc->trial, L_trial, Q_trial);
+            reciprocalEnergyTrial = gridEnergy(Q_trial, trialGeometry ? G_trial : G, F_trial);
+            qr_trial = chargeDipole(spc->trial);
+            trialFull = true;
+            cntFull++;
+          }
+
+          string _info() override {
+            using namespace Faunus::textio;
+            char w=25;
+            std::ostringstream o;
+            o << Tbase::_info();
+            o << header("Smooth particle-mesh Ewald");
+            o << pad(SUB,w, "Grid") << K[0] << "x" << K[1] << "x" << K[2] << endl
+              << pad(SUB,w, "B-spline order") << order << endl
+              << pad(SUB,w, "alpha") << alpha << endl
+              << pad(SUB,w, "Real cut-off") << Tbase::pairpot.first.rc << endl;
+            if (eps_surf < 1)
+              o << pad(SUB,w+1, epsilon_m+"(Surface)") << infinity << endl;
+            else
+              o << pad(SUB,w+1, epsilon_m+"(Surface)") << eps_surf << endl;
+            if (tolerance>0)
+              o << pad(SUB,w, "Deviation from Ewald") << toleranceError << " kT (tolerance " << tolerance << ")" << endl;
+            o << pad(SUB,w, "Local/full updates") << cntLocal << "/" << cntFull << endl
+              << pad(SUB,w, "Potential refreshes") << cntRefresh << endl
+              << pad(SUB,w, "Drift") << drift << endl;
+            return o.str();
+          }
+
+        public:
+          NonbondedSPME(Tmjson &j, const string &sec="nonbonded") : Tbase(j,sec) {
+            Tbase::name += " (SPME)";
+            auto _j = j["energy"]["nonbonded"]["ewald"];
+            lB = Tbase::pairpot.first.bjerrumLength();
+            alpha = _j.at("alpha");
+            eps_surf = _j.value("eps_surf", 0.0);
+            order = _j.value("order", 4);
+            spacing = _j.value("spacing", 1.0);
+            gridInput = _j.value("grid", 0);
+            tolerance = _j.value("tolerance", 0.0);
+            kc = _j.value("cutoffK", 0.0);
+            if (order<2 || order>maxOrder)
+              throw std::runtime_error("SPME: B-spline order must be in range [2:12]");
+            if (tolerance>0 && kc<=0)
+              throw std::runtime_error("SPME: 'tolerance' requires 'cutoffK'");
+            Tbase::pairpot.first.updateRcut(_j.at("cutoff"));
+            Tbase::pairpot.first.updateAlpha(alpha);
+            K[0]=K[1]=K[2]=1;
+            cntLocal=cntFull=cntRefresh=0;
+            N=0;
+            drift=toleranceError=0;
+            V=V_trial=1;
+            reciprocalEnergy=reciprocalEnergyTrial=surfaceEnergy=surfaceEnergyTrial=0;
+            initialized=trialPending=trialFull=trialGeometry=false;
+          }
+
+          /**
+           * @brief Set space and rebuild grid from `Space::p`
+           *
+           * Calls made between `updateChange()` and `update()`, as done by
+           * `Energy::energyChange` and `Move::Isobaric` for volume moves, leave
+           * the grid untouched.
+           */
+          void setSpace(Tspace &s) override {
+            Tbase::setSpace(s);
+            if (!trialPending)
+              init();
+          }
+
+          double updateChange(const typename Tspace::Change &c) override {
+            if (!initialized || spc->p.size() != N)
+              init();
+            trialPending = true;
+            trialFull = false;
+            trialGeometry = c.geometryChange;
+            delta.clear();
+            L_trial = L;
+            V_trial = V;
+            if (c.geometryChange || !c.rmGroup.empty() || !c.inGroup.empty()) {
+              fullTrial(c.geometryChange ? spc->geo_trial.len : L);
+              surfaceEnergyTrial = getSurfaceEnergy(qr_trial, V_trial);
+              return 0;
+            }
+            qr_trial = qr;
+            Stencil s;
+            auto &g = spc->groupList();
+            auto add = [&](int i) { // old charge removed and new charge, possibly changed, added
+              double qold = spc->p[i].charge, qnew = spc->trial[i].charge;
+              if (qold != 0) {
+                fillStencil(s, spc->p[i], -qold, L);
+                delta.push_back(s);
+              }
+              if (qnew != 0) {
+                fillStencil(s, spc->trial[i], qnew, L);
+                delta.push_back(s);
+              }
+              qr_trial += qnew*spc->trial[i] - qold*spc->p[i];
+            };
+            for (auto &m : c.mvGroup)
+              if (m.second.empty())
+                for (auto i : *g.at(m.first))
+                  add(i);
+              else
+                for (auto i : m.second)
+                  add(i);
+
+            // fall back to full grid update if cheaper
+            double p6 = std::pow(order,6);
+            double localCost = p6*delta.size()*(delta.size() + pending.size());
+            double fullCost = 2*fft.size()*std::log2(double(fft.size())) + std::pow(order,3)*spc->p.size();
+            if (localCost > fullCost)
+              fullTrial(L);
+            else {
+              double du=0;
+              for (size_t a=0; a<delta.size(); a++) {
+                du += 2*dot(phi, delta[a]);
+                for (auto &t : pending)
+                  du += 2*convolve(delta[a], t);
+                du += convolve(delta[a], delta[a]);
+                for (size_t b=a+1; b<delta.size(); b++)
+                  du += 2*convolve(delta[a], delta[b]);
+              }
+              reciprocalEnergyTrial = reciprocalEnergy + du;
+              cntLocal++;
+            }
+            surfaceEnergyTrial = getSurfaceEnergy(qr_trial, V_trial);
+            return 0;
+          }
+
+          /**
+           * @brief Adopt or discard trial state
+           *
+           * Returns the energy drift when the potential grid is refreshed
+           * from particle positions.
+           */
+          double update(bool move_accepted) override {
+            double du=0;
+            if (trialPending && move_accepted) {
+              if (trialFull) {
+                Q.swap(Q_trial);
+                if (trialGeometry) {
+                  G.swap(G_trial);
+                  L = L_trial;
+                  V = V_trial;
+                  realSpaceInfluence();
+                }
+                gridPotential(F_trial, G);
+                pending.clear();
+                reciprocalEnergy = reciprocalEnergyTrial;
+              } else {
+                for (auto &s : delta) {
+                  forEachPoint(s, [&](int i, double v) { Q[i] += v; });
+                  pending.push_back(s);
+                }
+                reciprocalEnergy = reciprocalEnergyTrial;
+                if (pending.size() > maxPending) {
+                  double old = reciprocalEnergy;
+                  chargeGrid(spc->p, L, Q);
+                  reciprocalEnergy = gridEnergy(Q, G, F);
+                  gridPotential(F, G);
+                  pending.clear();
+                  du = reciprocalEnergy - old;
+                  drift += std::fabs(du);
+                  cntRefresh++;
+                }
+              }
+              qr = qr_trial;
+              surfaceEnergy = surfaceEnergyTrial;
+              N = spc->p.size();
+            }
+            trialPending = false;
+            delta.clear();
+            return du;
+          }
+
+          double i_external(const Tpvec &p, int i) override {
+            Group g(i,i);
+            return g_external(p,g);
+          }
+
+          /** @brief Self energy of group */
+          double g_external(const Tpvec &p, Group &g) override {
+            double q2=0;
+            for (auto i : g)
+              q2 += p[i].charge*p[i].charge;
+            return -alpha*q2/std::sqrt(pc::pi)*lB;
+          }
+
+          bool isReentrant() override { return false; } // grids are updated on demand
+
+          /** @brief Reciprocal and surface energy */
+          double external(const Tpvec &p) override {
+            if (Tbase::isTrial(p) && trialPending)
+              return reciprocalEnergyTrial + surfaceEnergyTrial;
+            if (!initialized || (!trialPending && spc->p.size() != N))
+              init();
+            return reciprocalEnergy + surfaceEnergy;
+          }
+      };
   }//namespace
 }//namespace
 #endif
@@ -42,6 +42,7 @@
 #include <faunus/tabulate.h>
 #include <faunus/analysis.h>
 #include <faunus/scatter.h>
+#include <faunus/sasa.h>
 #include <faunus/spherocylinder.h>
 
 #endif
@@ -55,7 +55,7 @@ namespace Faunus
         string name;                                        //!< Name of the geometry
         inline int anint( double x ) const
         {
-            return int(x > 0. ? x + .5 : x - .5);
+            return int(x + std::copysign(.5, x)); // branchless round to nearest
         }
 
     public:
@@ -219,47 +219,54 @@ namespace Faunus
         /**
          * For reviews of minimum image algorithms,
          * see doi:10/ck2nrd and doi:10/kvs
+         *
+         * Branchless: for points inside the box the minimum image
+         * separation along each axis is `min(|d|, len-|d|)`.
          */
         inline double sqdist( const Point &a, const Point &b ) const override
         {
             Point d = (a - b).cwiseAbs();
-            for ( int i = 0; i < 3; ++i )
-                if ( d[i] > len_half[i] )
-                    d[i] -= 2 * len_half[i];
-            return d.squaredNorm();
+            return d.cwiseMin(len - d).squaredNorm();
+        }
 
-            // Alternative algorithm:
-            // Eigen::Vector3d d = a-b;
-            // Eigen::Vector3i k = (2*d.cwiseProduct(len_inv)).cast<int>();
-            // return (d-k.cast<double>().cwiseProduct(len)).squaredNorm();
+        /**
+         * @brief Squared distances from `a` to `n` points given as coordinate arrays
+         *
+         * Same as `sqdist(a,b)` for each point, but written as a single
+         * branchless loop that the compiler can vectorize. Coordinates are
+         * typically taken from `ParticleArrays`.
+         */
+        inline void sqdist( const Point &a, const double *x, const double *y, const double *z,
+                            int n, double *out ) const
+        {
+            const double ax = a.x(), ay = a.y(), az = a.z();
+            const double lx = len.x(), ly = len.y(), lz = len.z();
+            for ( int i = 0; i < n; ++i )
+            {
+                double dx = std::abs(ax - x[i]);
+                double dy = std::abs(ay - y[i]);
+                double dz = std::abs(az - z[i]);
+                dx = std::min(dx, lx - dx);
+                dy = std::min(dy, ly - dy);
+                dz = std::min(dz, lz - dz);
+                out[i] = dx * dx + dy * dy + dz * dz;
+            }
         }
 
         inline Point vdist( const Point &a, const Point &b ) override
         {
             Point r = a - b;
-            if ( r.x() > len_half.x())
-                r.x() -= len.x();
-            else if ( r.x() < -len_half.x())
-                r.x() += len.x();
-            if ( r.y() > len_half.y())
-                r.y() -= len.y();
-            else if ( r.y() < -len_half.y())
-                r.y() += len.y();
-            if ( r.z() > len_half.z())
-                r.z() -= len.z();
-            else if ( r.z() < -len_half.z())
-                r.z() += len.z();
+            r.x() -= len.x() * anint(r.x() * len_inv.x());
+            r.y() -= len.y() * anint(r.y() * len_inv.y());
+            r.z() -= len.z() * anint(r.z() * len_inv.z());
             return r;
         }
 
         inline void boundary( Point &a ) const override
         {
-            if ( std::abs(a.x()) > len_half.x())
-                a.x() -= len.x() * anint(a.x() * len_inv.x());
-            if ( std::abs(a.y()) > len_half.y())
-                a.y() -= len.y() * anint(a.y() * len_inv.y());
-            if ( std::abs(a.z()) > len_half.z())
-                a.z() -= len.z() * anint(a.z() * len_inv.z());
+            a.x() -= len.x() * anint(a.x() * len_inv.x());
+            a.y() -= len.y() * anint(a.y() * len_inv.y());
+            a.z() -= len.z() * anint(a.z() * len_inv.z());
         }
 
         void scale( Point &, Point &, const double, const double ) const override;
@@ -286,33 +293,40 @@ namespace Faunus
             double dx = std::abs(a.x() - b.x());
             double dy = std::abs(a.y() - b.y());
             double dz = a.z() - b.z();
-            if ( dx > len_half.x())
-                dx -= len.x();
-            if ( dy > len_half.y())
-                dy -= len.y();
+            dx = std::min(dx, len.x() - dx);
+            dy = std::min(dy, len.y() - dy);
             return dx * dx + dy * dy + dz * dz;
         }
 
+        /** @brief Squared distances from `a` to `n` points given as coordinate arrays */
+        inline void sqdist( const Point &a, const double *x, const double *y, const double *z,
+                            int n, double *out ) const
+        {
+            const double ax = a.x(), ay = a.y(), az = a.z();
+            const double lx = len.x(), ly = len.y();
+            for ( int i = 0; i < n; ++i )
+            {
+                double dx = std::abs(ax - x[i]);
+                double dy = std::abs(ay - y[i]);
+                double dz = az - z[i];
+                dx = std::min(dx, lx - dx);
+                dy = std::min(dy, ly - dy);
+                out[i] = dx * dx + dy * dy + dz * dz;
+            }
+        }
+
         inline Point vdist( const Point &a, const Point &b ) override
         {
             Point r(a - b);
-            if ( r.x() > len_half.x())
-                r.x() -= len.x();
-            else if ( r.x() < -len_half.x())
-                r.x() += len.x();
-            if ( r.y() > len_half.y())
-                r.y() -= len.y();
-            else if ( r.y() < -len_half.y())
-                r.y() += len.y();
+            r.x() -= len.x() * anint(r.x() * len_inv.x());
+            r.y() -= len.y() * anint(r.y() * len_inv.y());
             return r;
         }
 
         inline void boundary( Point &a ) const override
         {
-            if ( std::abs(a.x()) > len_half.x())
-                a.x() -= len.x() * anint(a.x() * len_inv.x());
-            if ( std::abs(a.y()) > len_half.y())
-                a.y() -= len.y() * anint(a.y() * len_inv.y());
+            a.x() -= len.x() * anint(a.x() * len_inv.x());
+            a.y() -= len.y() * anint(a.y() * len_inv.y());
         }
     };
 
@@ -326,6 +340,18 @@ namespace Faunus
 
         inline double sqdist( const Point &a, const Point &b ) const override { return (a - b).squaredNorm(); }
 
+        /** @brief Squared distances from `a` to `n` points given as coordinate arrays */
+        inline void sqdist( const Point &a, const double *x, const double *y, const double *z,
+                            int n, double *out ) const
+        {
+            const double ax = a.x(), ay = a.y(), az = a.z();
+            for ( int i = 0; i < n; ++i )
+            {
+                double dx = ax - x[i], dy = ay - y[i], dz = az - z[i];
+                out[i] = dx * dx + dy * dy + dz * dz;
+            }
+        }
+
         inline void boundary( Point &a ) const override {}
     };
 
@@ -394,22 +420,76 @@ namespace Faunus
             double dx = a.x() - b.x();
             double dy = a.y() - b.y();
             double dz = std::abs(a.z() - b.z());
-            if ( dz > _halflen )
-                dz -= _len;
+            dz = std::min(dz, _len - dz);
             return dx * dx + dy * dy + dz * dz;
         }
 
+        /** @brief Squared distances from `a` to `n` points given as coordinate arrays */
+        inline void sqdist( const Point &a, const double *x, const double *y, const double *z,
+                            int n, double *out ) const
+        {
+            const double ax = a.x(), ay = a.y(), az = a.z(), lz = _len;
+            for ( int i = 0; i < n; ++i )
+            {
+                double dx = ax - x[i];
+                double dy = ay - y[i];
+                double dz = std::abs(az - z[i]);
+                dz = std::min(dz, lz - dz);
+                out[i] = dx * dx + dy * dy + dz * dz;
+            }
+        }
+
         inline Point vdist( const Point &a, const Point &b ) override
         {
             Point r = a - b;
-            if ( r.z() > _halflen )
-                r.z() -= _len;
-            else if ( r.z() < -_halflen )
-                r.z() += _len;
+            r.z() -= _len * anint(r.z() / _len);
             return r;
         }
     };
 
+    /**
+     * @brief Trait for geometries with a batched `sqdist()` on coordinate arrays
+     *
+     * Geometries overriding `sqdist(a,b)` hide the batched version of their
+     * base class and hence fall back to point-by-point evaluation unless
+     * they provide their own.
+     */
+    template<class Tgeometry, class=void>
+    struct has_batched_sqdist : public std::false_type {};
+
+    template<class Tgeometry>
+    struct has_batched_sqdist<Tgeometry, decltype(std::declval<const Tgeometry &>().sqdist(
+        Point(), (const double *) nullptr, (const double *) nullptr, (const double *) nullptr, 0, (double *) nullptr))>
+        : public std::true_type {};
+
+    template<class Tgeometry>
+    void sqdist( const Tgeometry &geo, const Point &a, const double *x, const double *y, const double *z,
+                 int n, double *out, std::true_type )
+    {
+        geo.sqdist(a, x, y, z, n, out);
+    }
+
+    template<class Tgeometry>
+    void sqdist( const Tgeometry &geo, const Point &a, const double *x, const double *y, const double *z,
+                 int n, double *out, std::false_type )
+    {
+        for ( int i = 0; i < n; ++i )
+            out[i] = geo.sqdist(a, Point(x[i], y[i], z[i]));
+    }
+
+    /**
+     * @brief Squared distances from `a` to `n` points given as coordinate arrays
+     *
+     * Uses the batched `sqdist()` of the geometry if available, otherwise
+     * points are evaluated one at a time.
+     */
+    template<class Tgeometry>
+    void sqdist( const Tgeometry &geo, const Point &a, const double *x, const double *y, const double *z,
+                 int n, double *out )
+    {
+        sqdist(geo, a, x, y, z, n, out, has_batched_sqdist<Tgeometry>());
+    }
+
     /**
      * @brief Calculate center of cluster of particles
      * @param geo Geometry
@@ -847,6 +927,150 @@ namespace Faunus
         geo.boundary(com);
         return com;
     }
+
+    /**
+     * @brief Cell list for neighbor searches in rectangular, periodic boxes
+     *
+     * Indices of a set of positions are binned into a grid of cells with
+     * side lengths no smaller than a cutoff, `rc`. All positions within `rc`
+     * of a given point are thus found in the (up to) 27 surrounding cells,
+     * and single positions can be re-binned in constant time when they move.
+     * Cells wrap around all box boundaries so positions slightly outside
+     * the box are handled as well.
+     *
+     * Example:
+     *
+     * ~~~{.cpp}
+     * Geometry::CellList cells;
+     * cells.setup( spc.geo.len, 12.0 ); // box side lengths and cutoff
+     * cells.build( spc.p );
+     * cells.forEachNeighbor( spc.p[0], [&](int j) { ... } );
+     * cells.move( 0, spc.p[0] );        // re-bin particle 0 after a move
+     * ~~~
+     *
+     * Distances must still be calculated (and cut) by the caller as the
+     * cell neighbors form a superset of the particles within `rc`.
+     */
+    class CellList
+    {
+    private:
+        Point len;                               // box side lengths
+        Point cellinv;                           // inverse cell side lengths
+        Eigen::Vector3i n;                       // number of cells in each direction
+        std::vector<std::vector<int>> cells;     // indices in each cell
+        std::vector<std::vector<int>> neighbors; // surrounding cells of each cell (incl. itself)
+        std::vector<int> cellOf;                 // cell of each index
+
+        inline int wrap( int i, int d ) const
+        {
+            i %= n[d];
+            return (i < 0) ? i + n[d] : i;
+        }
+
+        inline int index( int x, int y, int z ) const { return (x * n[1] + y) * n[2] + z; }
+
+    public:
+        CellList() : len(0, 0, 0), cellinv(0, 0, 0), n(0, 0, 0) {}
+
+        /**
+         * @brief Set up empty grid
+         * @param boxlen Box side lengths
+         * @param rc Cutoff distance, i.e. minimum cell side length
+         * @param nmax Maximum number of cells in each direction (default: 64)
+         */
+        void setup( const Point &boxlen, double rc, int nmax = 64 )
+        {
+            assert(rc > 0 && "cutoff must be positive");
+            len = boxlen;
+            for ( int d = 0; d < 3; d++ )
+            {
+                n[d] = std::max(1, std::min(nmax, int(std::floor(len[d] / rc))));
+                cellinv[d] = n[d] / len[d];
+            }
+            cells.assign(n.prod(), std::vector<int>());
+            neighbors.resize(cells.size());
+            for ( int x = 0; x < n[0]; x++ )
+                for ( int y = 0; y < n[1]; y++ )
+                    for ( int z = 0; z < n[2]; z++ )
+                    {
+                        auto &nb = neighbors[index(x, y, z)];
+                        nb.clear();
+                        for ( int dx = -1; dx <= 1; dx++ )
+                            for ( int dy = -1; dy <= 1; dy++ )
+                                for ( int dz = -1; dz <= 1; dz++ )
+                                    nb.push_back(index(wrap(x + dx, 0), wrap(y + dy, 1), wrap(z + dz, 2)));
+                        std::sort(nb.begin(), nb.end()); // fewer than three cells in a direction
+                        nb.erase(std::unique(nb.begin(), nb.end()), nb.end()); // gives duplicates
+                    }
+            cellOf.clear();
+        }
+
+        /** @brief Cell index of position */
+        inline int cell( const Point &a ) const
+        {
+            return index(
+                wrap(int(std::floor((a.x() + 0.5 * len.x()) * cellinv.x())), 0),
+                wrap(int(std::floor((a.y() + 0.5 * len.y()) * cellinv.y())), 1),
+                wrap(int(std::floor((a.z() + 0.5 * len.z()) * cellinv.z())), 2));
+        }
+
+        /** @brief Bin all positions in vector, replacing any previous content */
+        template<class Tpvec>
+        void build( const Tpvec &p )
+        {
+            for ( auto &c : cells )
+                c.clear();
+            cellOf.resize(p.size());
+            for ( size_t i = 0; i < p.size(); i++ )
+            {
+                cellOf[i] = cell(p[i]);
+                cells[cellOf[i]].push_back(int(i));
+            }
+        }
+
+        /** @brief Re-bin index `i` to new position */
+        void move( int i, const Point &a )
+        {
+            assert(i >= 0 && i < int(cellOf.size()));
+            int c = cell(a);
+            if ( c != cellOf[i] )
+            {
+                auto &v = cells[cellOf[i]];
+                auto it = std::find(v.begin(), v.end(), i);
+                assert(it != v.end());
+                *it = v.back();
+                v.pop_back();
+                cells[c].push_back(i);
+                cellOf[i] = c;
+            }
+        }
+
+        /** @brief Call `f(j)` for all indices, `j`, in cells surrounding position `a` */
+        template<class Tfunc>
+        void forEachNeighbor( const Point &a, Tfunc f ) const
+        {
+            for ( auto c : neighbors[cell(a)] )
+                for ( auto j : cells[c] )
+                    f(j);
+        }
+
+        size_t size() const { return cellOf.size(); }      //!< Number of binned indices
+
+        size_t numCells() const { return cells.size(); }   //!< Total number of cells
+
+        const Point &boxLength() const { return len; }     //!< Box side lengths of current grid
+
+        /** @brief True if grid is set up for box `boxlen` with cells no smaller than `rc` */
+        bool fits( const Point &boxlen, double rc ) const
+        {
+            if ( cells.empty() || boxlen != len )
+                return false;
+            for ( int d = 0; d < 3; d++ )
+                if ( n[d] > 2 && len[d] / n[d] < rc ) // one or two cells are always neighbors
+                    return false;
+            return true;
+        }
+    };
   }//namespace Geometry
 }//namespace Faunus
 #endif
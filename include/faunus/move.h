@@ -130,6 +130,8 @@
             template<typename Tenergy, typename Tparticles>
             void induceDipoles( Tenergy &pot, Tparticles &p )
             {
+                static_assert(has_dipole<typename Tparticles::value_type>::value,
+                              "induced dipoles require a particle type with a dipole moment");
 
                 int cnt = 0;
                 Eigen::VectorXd mu_err_norm((int) p.size());
@@ -527,15 +529,20 @@
                 while ( n-- > 0 )
                 {
                     trialMove();
+                    spc->syncArrays(change);
                     pot->updateChange(change);
 
                     double du = energyChange();
                     acceptance = metropolis(du); // true or false?
                     if ( !acceptance )
+                    {
                         rejectMove();
+                        spc->undoArrays(change);
+                    }
                     else
                     {
                         acceptMove();
+                        spc->acceptArrays(change);
                         if ( useAlternativeReturnEnergy )
                             du = alternateReturnEnergy;
                         dusum += du;
@@ -1767,11 +1774,15 @@
          * :---------------| :----------------
          * `clusterradius` | Surface threshold from mobile ion to particle in group (angstrom)
          * `clustergroup`  | Group containing atomic particles to be moved with the main molecule
+         * `cutoff`        | Pair interaction cutoff between moved and static particles (angstrom, default: none)
          *
-         * @todo Energy evaluation puts all moved particles in an index vector used
-         * to sum the interaction energy with static particles. This could be optimized
-         * by only adding mobile ions and calculate i.e. group-group interactions in a
-         * more traditional (and faster) way.
+         * Mobile particles close to the main group are found using a cell list
+         * (`Geometry::CellList`) of the main group particles and cluster membership
+         * is kept as a per-particle flag. The interaction energy of moved particles,
+         * i.e. the main group and the cluster, is summed over static particles only.
+         * If a `cutoff` is given, only static particles in cells surrounding
+         * the moved particles are visited. This assumes that all pair
+         * interactions are zero beyond the cutoff.
          */
         template<class Tspace>
         class TranslateRotateCluster : public TranslateRotate<Tspace>
@@ -1797,6 +1808,52 @@
             Average<double> avgbias; //!< Average bias
             Group *gmobile;          //!< Pointer to group with potential cluster particles
             virtual double ClusterProbability( Tpvec &, int ); //!< Probability that particle index belongs to cluster
+
+            double cutoff;               // pair cutoff between moved and static particles
+            vector<char> moved;          // moved particles (main group and cluster)
+            vector<int> imoved;          // index of moved particles
+            Geometry::CellList gridOld;  // main group particles in `spc->p`
+            Geometry::CellList gridNew;  // main group particles in `spc->trial`
+            Geometry::CellList gridStatic; // all particles in `spc->p`; used with `cutoff`
+            vector<Point> gpos;
+            bool binnedOld = false, binnedNew = false;
+
+            void clearMoved()
+            {
+                for ( auto i : imoved )
+                    moved[i] = 0;
+                imoved.clear();
+                binnedOld = binnedNew = false;
+            }
+
+            /** @brief Bin positions, `pos`, in grid with minimum cell size `rc` */
+            template<class Tpositions>
+            void bin( Geometry::CellList &grid, const Tpositions &pos, double rc )
+            {
+                Point len = spc->geo.len;
+                if ( !(len.minCoeff() > 0 && len.allFinite()))
+                    len = Point(rc, rc, rc); // no box: single cell
+                if ( !grid.fits(len, rc))
+                    grid.setup(len, rc);
+                grid.build(pos);
+            }
+
+            /** @brief Bin main group particles of `p` */
+            Geometry::CellList &binGroup( Geometry::CellList &grid, const Tpvec &p )
+            {
+                double rmax = 0;
+                gpos.resize(igroup->size());
+                for ( int k = 0; k < igroup->size(); k++ )
+                {
+                    gpos[k] = p[igroup->front() + k];
+                    rmax = std::max(rmax, p[igroup->front() + k].radius);
+                }
+                for ( auto i : *gmobile )
+                    rmax = std::max(rmax, p[i].radius);
+                bin(grid, gpos, std::max(threshold + 2 * rmax, 1e-6));
+                return grid;
+            }
+
         public:
             using base::spc;
             TranslateRotateCluster( Energy::Energybase<Tspace> &, Tspace &, Tmjson &j );
@@ -1825,6 +1882,7 @@
                     string molname = spc->molList()[i.first].name;
                     string mobname = m[molname].at("clustergroup");
                     threshold = m[molname].at("threshold");
+                    cutoff = m[molname].value("cutoff", pc::infty);
                     dp_trans = m[molname].at("dp");
                     dp_rot = m[molname].at("dprot");
                     dir << j.value("dir", string("1 1 1") );  // magic!
@@ -1854,6 +1912,8 @@
             std::ostringstream o;
             o << base::_info() << endl;
             o << pad(SUB, w, "Cluster threshold") << threshold << _angstrom << endl;
+            if ( cutoff < pc::infty )
+                o << pad(SUB, w, "Pair cutoff") << cutoff << _angstrom << endl;
             if ( cnt > 0 )
             {
                 o << pad(SUB, w, "Average cluster size") << avgsize.avg() << endl;
@@ -1883,10 +1943,19 @@
 
             // find clustered particles
             cindex.clear();
+            binGroup(gridOld, spc->p);
+            binnedOld = true;
             for ( auto i : *gmobile )
                 if ( ClusterProbability(spc->p, i) > slump())
                     cindex.push_back(i); // generate cluster list
 
+            if ( moved.size() != spc->p.size())
+                moved.assign(spc->p.size(), 0);
+            for ( auto i : cindex )
+                moved[i] = 1, imoved.push_back(i);
+            for ( auto i : *igroup )
+                moved[i] = 1, imoved.push_back(i);
+
             // rotation
             Point p;
             if ( dp_rot > 1e-6 )
@@ -1910,6 +1979,11 @@
                 for ( auto i : cindex )
                     spc->trial[i].translate(spc->geo, p);
             }
+
+            // register moved particles: entire main group and clustered particles
+            base::change.mvGroup[spc->findIndex(igroup)].clear();
+            if ( !cindex.empty())
+                base::change.mvGroup[spc->findIndex(gmobile)] = cindex;
         }
 
         template<class Tspace>
@@ -1919,6 +1993,7 @@
             for ( auto i : cindex )
                 spc->p[i] = spc->trial[i];
             avgsize += cindex.size();
+            clearMoved();
         }
 
         template<class Tspace>
@@ -1927,15 +2002,17 @@
             base::_rejectMove();
             for ( auto i : cindex )
                 spc->trial[i] = spc->p[i];
+            clearMoved();
         }
 
         template<class Tspace>
         double TranslateRotateCluster<Tspace>::_energyChange()
         {
             double bias = 1;             // cluster bias -- see Frenkel 2nd ed, p.405
-            vector<int> imoved = cindex; // index of moved particles
+            binGroup(gridNew, spc->trial);
+            binnedNew = true;
             for ( auto l : *gmobile )    // mobile index, "l", NOT in cluster (Frenkel's "k" is the main group)
-                if ( std::find(cindex.begin(), cindex.end(), l) == cindex.end())
+                if ( !moved[l] )
                     bias *= (1 - ClusterProbability(spc->trial, l)) / (1 - ClusterProbability(spc->p, l));
             avgbias += bias;
             if ( bias < 1e-7 )
@@ -1944,9 +2021,6 @@
             if ( dp_rot < 1e-6 && dp_trans < 1e-6 )
                 return 0;
 
-            for ( auto i : *igroup )     // Add macromolecule to list of moved particle index
-                imoved.push_back(i);
-
             // container boundary collision?
             for ( auto i : imoved )
                 if ( spc->geo.collision(spc->trial[i], spc->trial[i].radius, Geometry::Geometrybase::BOUNDARY))
@@ -1966,13 +2040,31 @@
             }
 
             // pair energy between static and moved particles
-            // note: this could be optimized!
             double du = 0;
+            if ( cutoff < pc::infty )
+            {
+                double rc2 = cutoff * cutoff;
+                bin(gridStatic, spc->p, cutoff);
+                for ( auto i : imoved )
+                {
+                    gridStatic.forEachNeighbor(spc->trial[i], [&]( int j ) {
+                        if ( !moved[j] && spc->geo.sqdist(spc->trial[i], spc->trial[j]) < rc2 )
+                            du += pot->i2i(spc->trial, i, j);
+                    });
+                    gridStatic.forEachNeighbor(spc->p[i], [&]( int j ) {
+                        if ( !moved[j] && spc->geo.sqdist(spc->p[i], spc->p[j]) < rc2 )
+                            du -= pot->i2i(spc->p, i, j);
+                    });
+                }
+            }
+            else
+            {
 #pragma omp parallel for reduction (+:du)
-            for ( int j = 0; j < (int) spc->p.size(); j++ )
-                if ( std::find(imoved.begin(), imoved.end(), j) == imoved.end())
-                    for ( auto i : imoved )
-                        du += pot->i2i(spc->trial, i, j) - pot->i2i(spc->p, i, j);
+                for ( int j = 0; j < (int) spc->p.size(); j++ )
+                    if ( !moved[j] )
+                        for ( auto i : imoved )
+                            du += pot->i2i(spc->trial, i, j) - pot->i2i(spc->p, i, j);
+            }
             return unew - uold + du - log(bias); // exp[ -( dU-log(bias) ) ] = exp(-dU)*bias
         }
 
@@ -1985,13 +2077,27 @@
         template<class Tspace>
         double TranslateRotateCluster<Tspace>::ClusterProbability( Tpvec &p, int i )
         {
+            auto near = [&]( int j ) {
+                double r = threshold + p[i].radius + p[j].radius;
+                return i != j && spc->geo.sqdist(p[i], p[j]) < r * r;
+            };
+            Geometry::CellList *grid = nullptr;
+            if ( &p == &spc->p && binnedOld )
+                grid = &gridOld;
+            else if ( &p == &spc->trial && binnedNew )
+                grid = &gridNew;
+            if ( grid != nullptr )
+            {   // only main group particles in surrounding cells
+                bool found = false;
+                grid->forEachNeighbor(p[i], [&]( int k ) {
+                    if ( !found && near(igroup->front() + k))
+                        found = true;
+                });
+                return found ? 1 : 0;
+            }
             for ( auto j : *igroup ) // loop over main group
-                if ( i != j )
-                {
-                    double r = threshold + p[i].radius + p[j].radius;
-                    if ( spc->geo.sqdist(p[i], p[j]) < r * r )
-                        return 1;
-                }
+                if ( near(j))
+                    return 1;
             return 0;
         }
 
@@ -2617,6 +2723,12 @@
          * Note that new volumes are generated according to
          * \f$ V^{\prime} = \exp\left ( \log V \pm \delta dp \right ) \f$
          * where \f$\delta\f$ is a random number between zero and one half.
+         *
+         * If the scaling is isotropic and all groups are atomic or single
+         * particles, all distances scale by the same factor and the energy
+         * change is first requested from `Energybase::scaleChange()`, e.g. using
+         * `Energy::NonbondedHomogeneous`. If any energy term cannot be scaled,
+         * the energy is recalculated.
          */
         template<class Tspace>
         class Isobaric : public Movebase<Tspace>
@@ -2639,6 +2751,7 @@
             double dp; //!< Volume displacement parameter
             double oldval;
             double newval;
+            double scale;              //!< Isotropic length scaling of trial move; zero if not uniform
             Point oldlen;
             Point newlen;
             Average<double> msd;       //!< Mean squared volume displacement
@@ -2656,6 +2769,7 @@
 
             this->title = "Isobaric Volume Fluctuations";
             this->w = 30;
+            scale = 0;
             dp = j.at("dp");
             P = j.at("pressure").get<double>() * 1.0_mM;
             base::runfraction = j.value("prob", 1.0);
@@ -2744,6 +2858,15 @@
 
             spc->geo_trial.setlen(newlen);
 
+            // uniform scaling of all distances?
+            scale = newlen.x() / oldlen.x();
+            for ( int d = 1; d < 3; d++ )
+                if ( std::fabs(newlen[d] / oldlen[d] - scale) > 1e-12 * scale )
+                    scale = 0;
+            for ( auto g : spc->groupList())
+                if ( !g->isAtomic() && g->size() > 1 )
+                    scale = 0;
+
             // register all moved groups in change object
             int i = 0;
             for ( auto gPtr : spc->groupList())
@@ -2817,6 +2940,19 @@
         template<class Tspace>
         double Isobaric<Tspace>::_energyChange()
         {
+            if ( scale > 0 )
+            {
+                double du = pot->scaleChange(scale);
+                if ( !std::isnan(du))
+                {
+                    for ( auto g : spc->groupList())
+                        for ( auto i : *g )
+                            if ( spc->geo_trial.collision(spc->trial[i], spc->trial[i].radius,
+                                                          Geometry::Geometrybase::BOUNDARY))
+                                return pc::infty;
+                    return du;
+                }
+            }
             return Energy::energyChange(*spc, *pot, change);
         }
 
@@ -2924,6 +3060,22 @@
          * where `mysalt` must be an atomic molecule. Only atom types with
          * non-zero activities will be considered.
          *
+         * Keyword      | Description
+         * :----------- | :-----------------------------------------------
+         * `molecule`   | Atomic salt molecule
+         * `prob`       | Probability of running move (default: 1)
+         * `swap_erase` | Delete ions by swapping with the last salt ion (default: false)
+         * `reservoir`  | Number of extra particles to reserve storage for (default: 0)
+         *
+         * With `swap_erase`, deleted ions are replaced by the last ion of the
+         * salt group (`Space::eraseSwap()`) so that insertion and deletion
+         * touch only the end of the vectors instead of re-indexing all
+         * particles and groups beyond the deleted ions. This requires the salt
+         * group to be last in the particle vector, as when created by this
+         * move, which is checked on construction. The order of ions within
+         * the salt group is not preserved. `reservoir` avoids reallocation
+         * of the particle vectors as ions are inserted.
+         *
          * @date Lund 2010-2011
          * @warning Untested for asymmetric salt in this branch
          */
@@ -2970,6 +3122,18 @@
 
             Group *saltPtr;  // GC ions *must* be in this group
             int saltmolid;   // Molecular ID of salt
+            bool swapErase;  // delete by swapping with last ion of salt group
+
+            /** @brief Remove particles given by index */
+            void eraseIons( vector<int> &index )
+            {
+                std::sort(index.rbegin(), index.rend()); //reverse sort
+                for ( auto i : index )
+                    if ( swapErase )
+                        spc->eraseSwap(i);
+                    else
+                        spc->erase(i);
+            }
 
             // unit testing
             void _test( UnitTest &t ) override
@@ -2996,6 +3160,10 @@
             base::useAlternativeReturnEnergy = true;
             base::runfraction = j.value("prob", 1.0);
             string saltname = j.at("molecule");
+            swapErase = j.value("swap_erase", false);
+            int reservoir = j.value("reservoir", 0);
+            if ( reservoir > 0 )
+                spc->reserve(spc->p.size() + reservoir);
 
             auto v = spc->findMolecules(saltname);
             if ( v.empty())
@@ -3012,6 +3180,8 @@
                     throw std::runtime_error("Atomic GC group must be atomic.");
                 saltPtr = v.front();
             }
+            if ( swapErase && saltPtr->back() + 1 != (int) spc->p.size())
+                throw std::runtime_error("'swap_erase' requires the GC salt group to be last in the particle vector.");
             add(*saltPtr);
         }
 
@@ -3192,9 +3362,7 @@
 
             if ( !trial_delete.empty()) {
                 assert(saltPtr!=nullptr);
-                std::sort(trial_delete.rbegin(), trial_delete.rend()); //reverse sort
-                for ( auto i : trial_delete )
-                    spc->erase(i);
+                eraseIons(trial_delete);
             }
 
             double V = spc->geo.getVolume();
@@ -3267,6 +3435,7 @@
          *  `avgfile`    | Save AAM/PQR file w. average charges at end of simulation (TODO)
          *  `scale2int`  | When saving `avgfile`, scale charges to ensure integer net charge (default: `false`)
          *  `processes`  | List of equilibrium processes, see `Energy::EquilibriumController`
+         *  `swap_erase`, `reservoir` | See `GrandCanonicalSalt`
          *
          * @todo: contains lots of redundant code from SwapMove, could inherit from there
          * as well
@@ -3611,11 +3780,7 @@
                     base::saltPtr = spc->insert( base::saltmolid, base::trial_insert );
                 }
                 else if ( !base::trial_delete.empty())
-                {
-                    std::sort(base::trial_delete.rbegin(), base::trial_delete.rend()); //reverse sort
-                    for ( auto i : base::trial_delete )
-                        spc->erase(i);
-                }
+                    base::eraseIons(base::trial_delete);
                 double V = spc->geo.getVolume();
                 base::map[pid].rho += spc->atomTrack[pid].size() / V;
                 accmap[isite] += 1;
@@ -4235,6 +4400,11 @@
          * This is a general class for GCMC that can handle both
          * atomic and molecular species at constant chemical potential.
          *
+         * Molecules are deleted as whole groups with `Space::eraseGroup()`.
+         * Insertion and deletion of atomic species are not finished, so
+         * `Space::eraseSwap()`, used by `GrandCanonicalSalt`, is not applied
+         * here.
+         *
          * @todo Currently tested only with rigid, molecular species. Move
          *       external energy calculation into Hamiltonian. Move particle
          *       density analysis to Faunus::Analysis.
@@ -409,11 +409,18 @@ namespace Faunus {
          * 
          *  - On the dielectric constant, http://dx.doi.org/10.1080/00268978300102721
          *  - Generalized reaction field using ionic strength, http://dx.doi.org/10.1063/1.469273
+         *
+         *  The splitting function is tabulated with `Ttabulator`; `CoulombGalore` uses
+         *  `Tabulate::Andrea` while `Tabulate::Uniform` avoids the binary search in each
+         *  evaluation. If `tab_cache` is given as a file prefix, the table is stored on disk
+         *  and reused by later runs with the same settings (see `Tabulate::TableCache`).
          */
-        class CoulombGalore : public PairPotentialBase {
+        template<class Ttabulator=Tabulate::Andrea<double> >
+        class CoulombGaloreTabulate : public PairPotentialBase {
             private:
-                Tabulate::Andrea<double> sf; // splitting function
-                Tabulate::TabulatorBase<double>::data table; // data for splitting function
+                Ttabulator sf; // splitting function
+                typename Ttabulator::data table; // data for splitting function
+                Tabulate::TableCache<double> cache; // on-disk storage of `table`
                 std::function<double(double)> calcDielectric; // function for dielectric const. calc.
                 string type;
 		double selfenergy_prefactor;
@@ -423,13 +430,13 @@ namespace Faunus {
                 void sfYukawa(const Tmjson &j) {
                     kappa = 1.0 / j.at("debyelength").get<double>();
                     I = kappa*kappa / ( 8.0*lB*pc::pi*pc::Nav/1e27 );
-                    table = sf.generate( [&](double q) { return std::exp(-q*rc*kappa) - std::exp(-kappa*rc); } ); // q=r/Rc 
+                    table = cache.generate( sf, [&](double q) { return std::exp(-q*rc*kappa) - std::exp(-kappa*rc); }, j.dump() ); // q=r/Rc 
                     // we could also fill in some info string or JSON output...
                 }
 
                 void sfReactionField(const Tmjson &j) {
                     epsrf = j.at("eps_rf");
-                    table = sf.generate( [&](double q) { return 1 + (( epsrf - epsr ) / ( 2 * epsrf + epsr ))*q*q*q - 3 * ( epsrf / ( 2 * epsrf + epsr ))*q ; } ); 
+                    table = cache.generate( sf, [&](double q) { return 1 + (( epsrf - epsr ) / ( 2 * epsrf + epsr ))*q*q*q - 3 * ( epsrf / ( 2 * epsrf + epsr ))*q ; }, j.dump() ); 
                     calcDielectric = [&](double M2V) {
                         if(epsrf > 1e10)
                             return 1 + 3*M2V;
@@ -447,7 +454,7 @@ namespace Faunus {
                 void sfQpotential(const Tmjson &j)
                 {
                     order = j.value("order",300);
-                    table = sf.generate( [&](double q) { return qPochhammerSymbol( q, 1, order ); } );
+                    table = cache.generate( sf, [&](double q) { return qPochhammerSymbol( q, 1, order ); }, j.dump() );
                     calcDielectric = [&](double M2V) { return 1 + 3*M2V; };
 		    selfenergy_prefactor = 0.5;
                 }
@@ -455,20 +462,20 @@ namespace Faunus {
                 void sfYonezawa(const Tmjson &j)
                 {
                     alpha = j.at("alpha");
-                    table = sf.generate( [&](double q) { return 1 - erfc(alpha*rc)*q + q*q; } );
+                    table = cache.generate( sf, [&](double q) { return 1 - erfc(alpha*rc)*q + q*q; }, j.dump() );
 		    calcDielectric = [&](double M2V) { return 1 + 3*M2V; };
 		    selfenergy_prefactor = erf(alpha*rc);
                 }
 
                 void sfFanourgakis(const Tmjson &j) {
-                    table = sf.generate( [&](double q) { return 1 - 1.75*q + 5.25*pow(q,5) - 7*pow(q,6) + 2.5*pow(q,7); } );
+                    table = cache.generate( sf, [&](double q) { return 1 - 1.75*q + 5.25*pow(q,5) - 7*pow(q,6) + 2.5*pow(q,7); }, j.dump() );
                     calcDielectric = [&](double M2V) { return 1 + 3*M2V; };
 		    selfenergy_prefactor = 0.875;
                 }
 
                 void sfFennel(const Tmjson &j) {
                     alpha = j.at("alpha");
-                    table = sf.generate( [&](double q) { return (erfc(alpha*rc*q) - erfc(alpha*rc)*q + (q-1.0)*q*(erfc(alpha*rc) + 2 * alpha * rc / sqrt(pc::pi) * exp(-alpha*alpha*rc*rc))); } );
+                    table = cache.generate( sf, [&](double q) { return (erfc(alpha*rc*q) - erfc(alpha*rc)*q + (q-1.0)*q*(erfc(alpha*rc) + 2 * alpha * rc / sqrt(pc::pi) * exp(-alpha*alpha*rc*rc))); }, j.dump() );
 		    calcDielectric = [&](double M2V) { double T = erf(alpha*rc) - (2 / (3 * sqrt(pc::pi))) * exp(-alpha*alpha*rc*rc) * (alpha*alpha*rc*rc * alpha*alpha*rc*rc + 2.0 * alpha*alpha*rc*rc + 3.0);
 						       return (((T + 2.0) * M2V + 1.0)/ ((T - 1.0) * M2V + 1.0)); };
 		    selfenergy_prefactor = ( erfc(alpha*rc)/2.0 + alpha*rc/sqrt(pc::pi) );
@@ -476,20 +483,20 @@ namespace Faunus {
 
                 void sfWolf(const Tmjson &j) {
                     alpha = j.at("alpha");
-                    table = sf.generate( [&](double q) { return (erfc(alpha*rc*q) - erfc(alpha*rc)*q); } );
+                    table = cache.generate( sf, [&](double q) { return (erfc(alpha*rc*q) - erfc(alpha*rc)*q); }, j.dump() );
 		    calcDielectric = [&](double M2V) { double T = erf(alpha*rc) - (2 / (3 * sqrt(pc::pi))) * exp(-alpha*alpha*rc*rc) * ( 2.0 * alpha*alpha*rc*rc + 3.0);
 						       return (((T + 2.0) * M2V + 1.0)/ ((T - 1.0) * M2V + 1.0));};
 		    selfenergy_prefactor = ( erfc(alpha*rc) + alpha*rc/sqrt(pc::pi)*(1.0 + exp(-alpha*alpha*rc2)) );
                 }
 
                 void sfPlain(const Tmjson &j, double val=1) {
-                    table = sf.generate( [&](double q) { return val; } );
+                    table = cache.generate( sf, [&](double q) { return val; }, j.dump() );
 		    calcDielectric = [&](double M2V) { return (2.0*M2V + 1.0)/(1.0 - M2V); };
 		    selfenergy_prefactor = 0.0;
                 }
 
             public:
-                CoulombGalore(const Tmjson &j) {
+                CoulombGaloreTabulate(const Tmjson &j) {
                     try {
                         type = j.at("coulombtype");
                         name = "Coulomb-" + textio::toupper_first( type );
@@ -503,6 +510,7 @@ namespace Faunus {
                         sf.setRange(0, 1);
                         sf.setTolerance(
                                 j.value("tab_utol",1e-9),j.value("tab_ftol",1e-2) );
+                        cache = Tabulate::TableCache<double>( j.value("tab_cache", std::string()) );
 
                         if (type=="reactionfield") sfReactionField(j);
                         if (type=="fanourgakis") sfFanourgakis(j);
@@ -534,16 +542,30 @@ namespace Faunus {
                         return 0;
                     }
 
+                /** @brief Energies in kT between `a` and a block of partners */
+                template<class Tparticle>
+                    void batch(const Tparticle &a, const PairBlock &b, double *u) const {
+                        const double s = lB * a.charge, *q = b.charge, *r2 = b.r2;
+                        for (int k=0, n=b.size; k<n; k++) {
+                            u[k] = 0;
+                            if (r2[k] < rc2) {
+                                double r = sqrt(r2[k]);
+                                u[k] = s * q[k] / r * sf.eval( table, r*rc1i );
+                            }
+                        }
+                    }
+
                 template<class Tparticle>
                     double operator()(const Tparticle &a, const Tparticle &b, const Point &r) const {
                         return operator()(a,b,r.squaredNorm());
                     }
 
+                /** @brief Force, -du/dr along `p`, with `Ttabulator::evalDer()` giving the derivative of the splitting function */
                 template<typename Tparticle>
                     Point force(const Tparticle &a, const Tparticle &b, double r2, const Point &p) {
                         if (r2 < rc2) {
-                            double r = sqrt(r2);
-                            return lB * a.charge * b.charge * ( -sf.eval( table, r*rc1i )/r2 + sf.evalDer( table, r*rc1i )/r )*p;
+                            double r = sqrt(r2), q = r*rc1i;
+                            return lB * a.charge * b.charge * ( sf.eval( table, q )/r - sf.evalDer( table, q )*rc1i ) / r2 * p;
                         }
                         return Point(0,0,0);
                     }
@@ -589,6 +611,10 @@ namespace Faunus {
                 }
         };
 
+        typedef CoulombGaloreTabulate<> CoulombGalore;
+
+        template<class Ttabulator> struct is_batched<CoulombGaloreTabulate<Ttabulator> > : public std::true_type {};
+
         /**
          * @brief Help-function for `sfQpotential` using order 3.
          */
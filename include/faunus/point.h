@@ -9,6 +9,8 @@
 
 #pragma GCC diagnostic pop
 #include <vector>
+#include <type_traits>
+#include <utility>
 
 #endif
 
@@ -427,6 +429,15 @@ namespace Faunus
     /**
      * @brief Class for isotropic particles
      *
+     * Anisotropic properties such as dipole moments or cap geometries are
+     * available through the same accessors as in derived particle types
+     * so that generic code may call e.g. `mu()` on any particle. For
+     * isotropic particles these are static traits with no per-particle
+     * storage and only constant accessors, returning zero (`is_sphere()`
+     * returns true). Generic code that writes e.g. dipoles should check
+     * `has_dipole` so that misuse fails at compile time.
+     * Data members are ordered so that the particle fits in 64 bytes.
+     *
      * Example:
      *
      * ~~~
@@ -445,17 +456,12 @@ namespace Faunus
         typedef Point::Tcoord Talphax;
         typedef unsigned char Tid;
         typedef bool Thydrophobic;
-        Tid id;                                   //!< Particle identifier
         Tcharge charge;                           //!< Charge number
         Tradius radius;                           //!< Radius
         Talphax alphax;
         Tmw mw;                                   //!< Molecular weight
+        Tid id;                                   //!< Particle identifier
         Thydrophobic hydrophobic;                 //!< Hydrophobic flag
-        
-        Tensor<double> zeroT;
-        Point zeroP;
-        double zeroD;
-	bool trueD;
 
         PointParticle() { clear(); }              //!< Constructor
 
@@ -473,29 +479,19 @@ namespace Faunus
 
         Tcharge q() const { return charge; }
 
-        Point mu() const { return zeroP; }
-        Point mup() const { return zeroP; }
-        double muscalar() const { return zeroD; }
-        Point& mu() { return zeroP; }
-        Point& mup() { return zeroP; }
-        double& muscalar() { return zeroD; }
-
-        Point cap_center_point() const { return zeroP; } 
-        Point charge_position() const { return zeroP; }
-        double cap_radius() const { return zeroD; }
-        double cap_center() const { return zeroD; }
-        double angle_p() const { return zeroD; }
-        double angle_c() const { return zeroD; }
-        bool is_sphere() const { return trueD; }
-        Point& cap_center_point() { return zeroP; } 
-        Point& charge_position() { return zeroP; }
-        double& cap_radius() { return zeroD; }
-        double& cap_center() { return zeroD; }
-        double& angle_p() { return zeroD; }
-        double& angle_c() { return zeroD; }
-        bool& is_sphere() { return trueD; }
-        Tensor<double> alpha() const { return zeroT; }
-	Tensor<double> theta() const { return zeroT; }
+        Point mu() const { return Point(0,0,0); }
+        Point mup() const { return Point(0,0,0); }
+        double muscalar() const { return 0; }
+
+        Point cap_center_point() const { return Point(0,0,0); }
+        Point charge_position() const { return Point(0,0,0); }
+        double cap_radius() const { return 0; }
+        double cap_center() const { return 0; }
+        double angle_p() const { return 0; }
+        double angle_c() const { return 0; }
+        bool is_sphere() const { return true; }
+        Tensor<double> alpha() const { return Tensor<double>(); }
+        Tensor<double> theta() const { return Tensor<double>(); }
 
         template<class T,
             class = typename std::enable_if<std::is_base_of<AtomData, T>::value>::type>
@@ -556,9 +552,6 @@ namespace Faunus
             charge = mw = radius = alphax = 0;
             hydrophobic = false;
             id = 0;
-            zeroP = Point(0,0,0);
-            zeroD = 0.0;
-	    trueD = true;
         }
 
     };
@@ -923,5 +916,22 @@ namespace Faunus
                     _charge_position = rot(_charge_position);
                 }
     };
+
+    /**
+     * @brief True if particle type `T` stores a dipole moment, i.e. `mu()` and `muscalar()` are writable
+     *
+     * Example:
+     *
+     * ~~~
+     * static_assert( has_dipole<DipoleParticle>::value, "" );
+     * static_assert( !has_dipole<PointParticle>::value, "" );
+     * ~~~
+     */
+    template<class T, class = void>
+        struct has_dipole : std::false_type {};
+
+    template<class T>
+        struct has_dipole<T, decltype(void(std::declval<T&>().muscalar() = 0), void(std::declval<T&>().mu() = Point()))>
+        : std::true_type {};
 }//namespace
 #endif
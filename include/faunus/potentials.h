@@ -14,6 +14,10 @@
 
 namespace Faunus {
 
+  namespace Tabulate {
+    template<typename T> class Uniform; // see tabulate.h; used by `Potential::PotentialMap`
+  }
+
   /**
    * @brief Namespace for pair potentials
    *
@@ -118,6 +122,58 @@ namespace Faunus {
         virtual std::string info(char=20);
     };
 
+    /**
+     * @brief Block of pair partners for batched energy evaluation
+     *
+     * Squared distances and partner properties are stored in plain
+     * arrays so that loops over a block can be vectorized by the
+     * compiler. Pair potentials marked with `is_batched` provide
+     *
+     *     template<class Tparticle>
+     *       void batch(const Tparticle &a, const PairBlock &b, double *u) const;
+     *
+     * which writes the energy (kT) between `a` and each of the `b.size`
+     * partners to `u`. The result must be identical to calling the
+     * function operator one pair at a time.
+     */
+    struct PairBlock {
+      static const int capacity = 256; //!< Maximum number of partners in a block
+      const double *r2;                //!< Squared distances (angstrom^2)
+      const double *charge;            //!< Partner charges
+      const double *radius;            //!< Partner radii (angstrom)
+      const int *id;                   //!< Partner atom type id's
+      int size;                        //!< Number of partners
+    };
+
+    /**
+     * @brief Trait for pair potentials with a `batch()` function
+     *
+     * Must be specialized explicitly for each supported potential as
+     * derived potentials (`CutShift`, `CoulombWolf` etc.) inherit
+     * `batch()` without respecting their own modifications.
+     */
+    template<class T>
+      struct is_batched : public std::false_type {};
+
+    /**
+     * @brief Trait for homogeneous pair potentials, @f$ u(r) = \sum_k c_k r^{-n_k} @f$
+     *
+     * Specializations give the number of terms, `size`, and their exponents,
+     * `exponent(k)`, while the pair potential implements
+     *
+     *     void terms(const Tparticle &a, const Tparticle &b, double r2, double *u) const
+     *
+     * which adds term `k` of the pair energy (kT) to `u[k]`. Scaling all
+     * distances by `s` thus scales term `k` by @f$ s^{-n_k} @f$. As for
+     * `is_batched`, specializations must be explicit since derived potentials
+     * typically add cutoffs or shifts.
+     */
+    template<class T>
+      struct homogeneous {
+        static const int size = 0; //!< Number of terms; zero if not homogeneous
+        static constexpr int exponent( int ) { return 0; }
+      };
+
     /**
      * @brief Save pair potential and force table to disk
      *
@@ -394,11 +450,13 @@ namespace Faunus {
      */
     class FENE : public PairPotentialBase {
       private:
-        double k, r02, r02inv;
-
         string _brief();
 
       public:
+        double k;      //!< Stiffness (kT)
+        double r02;    //!< Squared maximum separation (angstrom^2)
+        double r02inv; //!< Inverse of `r02`
+
         FENE(double k_kT, double rmax_A);
 
         FENE( Tmjson &j ) {
@@ -420,6 +478,119 @@ namespace Faunus {
           }
     };
 
+    /**
+     * @brief Harmonic angle potential between three particles
+     *
+     * @f[ \beta u = k(\theta-\theta_0)^2 @f]
+     *
+     * where @f$\theta@f$ is the angle between the bond vectors
+     * `i-j` and `k-j`, i.e. the middle index is the vertex.
+     * As for `Harmonic`, the 1/2 prefactor must be included in `k`.
+     *
+     * ~~~~
+     * Potential::Angular a( {3,4,5}, 70., 0.5 ); // theta0=70 degrees, k=0.5 kT/rad^2
+     * ~~~~
+     */
+    class Angular {
+      private:
+        std::vector<int> index;
+      public:
+        double k;      //!< Force constant (kT/rad^2)
+        double theta0; //!< Equilibrium angle (radians)
+
+        Angular( const std::vector<int> &ijk, double theta0_deg, double k_kT ) : index(ijk), k(k_kT) {
+          if (index.size()!=3)
+            throw std::runtime_error("Angular potential requires exactly three particle indices");
+          theta0 = theta0_deg * pc::pi / 180;
+        }
+
+        const std::vector<int>& getIndex() const { return index; }
+
+        string brief() const {
+          std::ostringstream o;
+          o << "Angular: " << index[0] << "-" << index[1] << "-" << index[2]
+            << " k=" << k << textio::kT << " theta0=" << theta0*180/pc::pi << textio::degrees;
+          return o.str();
+        }
+
+        /** @brief Energy (kT) of angle `i-j-k` with `j` as vertex */
+        template<class Tgeometry, class Tpvec>
+          static inline double energy(Tgeometry &geo, const Tpvec &p, int i, int j, int l, double k, double theta0) {
+            Point a = geo.vdist(p[i], p[j]);
+            Point b = geo.vdist(p[l], p[j]);
+            double c = a.dot(b) / std::sqrt( a.squaredNorm() * b.squaredNorm() );
+            double theta = std::acos( std::max(-1.0, std::min(1.0, c)) );
+            return k * (theta-theta0) * (theta-theta0);
+          }
+
+        template<class Tgeometry, class Tpvec>
+          double operator()(Tgeometry &geo, const Tpvec &p) const {
+            return energy(geo, p, index[0], index[1], index[2], k, theta0);
+          }
+    };
+
+    /**
+     * @brief Periodic dihedral potential between four particles
+     *
+     * @f[ \beta u = k\left [ 1+\cos(n\phi-\phi_0) \right ] @f]
+     *
+     * where @f$\phi@f$ is the torsion angle around the `j-k` bond,
+     * zero for the cis conformation.
+     *
+     * ~~~~
+     * Potential::Dihedral d( {0,1,2,3}, 1.2, 3, 0. ); // k=1.2 kT, n=3, phi0=0 degrees
+     * ~~~~
+     */
+    class Dihedral {
+      private:
+        std::vector<int> index;
+      public:
+        double k;    //!< Barrier height (kT)
+        double n;    //!< Multiplicity
+        double phi0; //!< Phase (radians)
+
+        Dihedral( const std::vector<int> &ijkl, double k_kT, double multiplicity, double phi0_deg )
+          : index(ijkl), k(k_kT), n(multiplicity) {
+            if (index.size()!=4)
+              throw std::runtime_error("Dihedral potential requires exactly four particle indices");
+            phi0 = phi0_deg * pc::pi / 180;
+          }
+
+        const std::vector<int>& getIndex() const { return index; }
+
+        string brief() const {
+          std::ostringstream o;
+          o << "Dihedral: " << index[0] << "-" << index[1] << "-" << index[2] << "-" << index[3]
+            << " k=" << k << textio::kT << " n=" << n << " phi0=" << phi0*180/pc::pi << textio::degrees;
+          return o.str();
+        }
+
+        /** @brief Torsion angle (radians) around the `j-k` bond */
+        template<class Tgeometry, class Tpvec>
+          static inline double angle(Tgeometry &geo, const Tpvec &p, int i, int j, int k, int l) {
+            Point b1 = geo.vdist(p[j], p[i]);
+            Point b2 = geo.vdist(p[k], p[j]);
+            Point b3 = geo.vdist(p[l], p[k]);
+            Point n1 = b1.cross(b2);
+            Point n2 = b2.cross(b3);
+            double x = n1.dot(n2);
+            double y = n1.cross(n2).dot(b2) / b2.norm();
+            return std::atan2(y, x);
+          }
+
+        /** @brief Energy (kT) of torsion `i-j-k-l` */
+        template<class Tgeometry, class Tpvec>
+          static inline double energy(Tgeometry &geo, const Tpvec &p, int i, int j, int k, int l,
+              double kd, double n, double phi0) {
+            return kd * ( 1 + std::cos( n*angle(geo, p, i, j, k, l) - phi0 ) );
+          }
+
+        template<class Tgeometry, class Tpvec>
+          double operator()(Tgeometry &geo, const Tpvec &p) const {
+            return energy(geo, p, index[0], index[1], index[2], index[3], k, n, phi0);
+          }
+    };
+
     /**
      * @brief Hertz pair potential
      */
@@ -672,6 +843,25 @@ namespace Faunus {
             double x(r6(a.radius+b.radius,r2));
             return eps*(x*x - x);
           }
+
+        /** @brief Energies in kT between `a` and a block of partners */
+        template<class Tparticle>
+          void batch(const Tparticle &a, const PairBlock &b, double *u) const {
+            const double e=eps, ra=a.radius, *rb=b.radius, *r2=b.r2;
+            for (int k=0, n=b.size; k<n; k++) {
+              double x(r6(ra+rb[k], r2[k]));
+              u[k] = e*(x*x - x);
+            }
+          }
+
+        /** @brief Adds r^-12 and r^-6 terms to `u[0]` and `u[1]` */
+        template<class Tparticle>
+          void terms(const Tparticle &a, const Tparticle &b, double r2, double *u) const {
+            double x(r6(a.radius+b.radius,r2));
+            u[0] += eps*x*x;
+            u[1] -= eps*x;
+          }
+
         template<class Tparticle>
           double operator() (const Tparticle &a, const Tparticle &b, const Point &r) {
             return operator()(a,b,r.squaredNorm());
@@ -687,6 +877,13 @@ namespace Faunus {
         string info(char);
     };
 
+    template<> struct is_batched<LennardJones> : public std::true_type {};
+
+    template<> struct homogeneous<LennardJones> {
+      static const int size = 2;
+      static constexpr int exponent( int k ) { return k==0 ? 12 : 6; }
+    };
+
     /**
      * @brief Cuts a pair-potential and shift to zero at cutoff
      *
@@ -823,6 +1020,27 @@ namespace Faunus {
               return eps(a.id,b.id) * (x*x - x);
             }
 
+          /** @brief Energies in kT between `a` and a block of partners */
+          template<class Tparticle>
+            void batch(const Tparticle &a, const PairBlock &b, double *u) const {
+              const double *s2a = s2.m[a.id].data(), *epsa = eps.m[a.id].data(), *r2 = b.r2;
+              const int *id = b.id;
+              for (int k=0, n=b.size; k<n; k++) {
+                double x=s2a[ id[k] ]/r2[k];
+                x=x*x*x;
+                u[k] = epsa[ id[k] ] * (x*x - x);
+              }
+            }
+
+          /** @brief Adds r^-12 and r^-6 terms to `u[0]` and `u[1]` */
+          template<class Tparticle>
+            void terms(const Tparticle &a, const Tparticle &b, double r2, double *u) const {
+              double x=s2(a.id,b.id)/r2;
+              x=x*x*x;
+              u[0] += eps(a.id,b.id) * x*x;
+              u[1] -= eps(a.id,b.id) * x;
+            }
+
           template<typename Tparticle>
             Point force(const Tparticle &a, const Tparticle &b, double r2, const Point &p) {
               double s6=_powi<3>( s2(a.id,b.id) );
@@ -899,6 +1117,12 @@ namespace Faunus {
           }
       };
 
+    template<class Tmixingrule>
+      struct is_batched<LennardJonesMixed<Tmixingrule>> : public std::true_type {};
+
+    template<class Tmixingrule>
+      struct homogeneous<LennardJonesMixed<Tmixingrule>> : public homogeneous<LennardJones> {};
+
     template<class Tmixingrule=LorentzBerthelot>
       class CosAttractMixed : public LennardJonesMixed<Tmixingrule> {
         protected:
@@ -1210,6 +1434,24 @@ namespace Faunus {
 #endif
         }
 
+      /** @brief Energies in kT between `a` and a block of partners */
+      template<class Tparticle>
+        void batch(const Tparticle &a, const PairBlock &b, double *u) const {
+          const double s=lB*a.charge, *q=b.charge, *r2=b.r2;
+          for (int k=0, n=b.size; k<n; k++)
+#ifdef FAU_APPROXMATH
+            u[k] = s*q[k] * invsqrtQuake(r2[k]);
+#else
+            u[k] = s*q[k] / sqrt(r2[k]);
+#endif
+        }
+
+      /** @brief Adds the r^-1 term to `u[0]` */
+      template<class Tparticle>
+        void terms(const Tparticle &a, const Tparticle &b, double r2, double *u) const {
+          u[0] += operator()(a,b,r2);
+        }
+
       template<class Tparticle>
         double operator() (const Tparticle &a, const Tparticle &b, const Point &r) {
           return operator()(a,b,r.squaredNorm());
@@ -1237,6 +1479,13 @@ namespace Faunus {
       void test(UnitTest&); //!< Perform unit test
     };
 
+    template<> struct is_batched<Coulomb> : public std::true_type {};
+
+    template<> struct homogeneous<Coulomb> {
+      static const int size = 1;
+      static constexpr int exponent( int ) { return 1; }
+    };
+
     /**
      * @brief Coulomb pair potential shifted according to Wolf/Yonezawa
      * @details The potential has the form:
@@ -1453,6 +1702,21 @@ namespace Faunus {
 #endif
           }
 
+        /** @brief Energies in kT between `a` and a block of partners */
+        template<class Tparticle>
+          void batch(const Tparticle &a, const PairBlock &b, double *u) const {
+            const double s=lB*a.charge, kappa=k, *q=b.charge, *r2=b.r2;
+            for (int i=0, n=b.size; i<n; i++) {
+#ifdef FAU_APPROXMATH
+              double rinv = invsqrtQuake(r2[i]);
+              u[i] = s * q[i] * rinv * exp_cawley(-kappa/rinv);
+#else
+              double r=sqrt(r2[i]);
+              u[i] = s * q[i] / r * exp(-kappa*r);
+#endif
+            }
+          }
+
         double entropy(double, double) const;         //!< Returns the interaction entropy
         double ionicStrength() const;                 //!< Returns the ionic strength (mol/l)
         double debyeLength() const;                   //!< Returns the Debye screening length (angstrom)
@@ -1501,6 +1765,9 @@ namespace Faunus {
             }
           }
     };
+
+    template<> struct is_batched<DebyeHuckel> : public std::true_type {};
+
     /**
      * @brief Debye-Huckel potential
      * @details Unlike in the Debye-Huckel/Yukawa potential,
@@ -1787,17 +2054,37 @@ namespace Faunus {
      *     PotentialMap<CoulombLJ> pot(...);
      *     pot.add( atom["Na"].id ,atom["CH4"].id, ChargeNonpolar(...) );
      *     pot.add( atom["Cl"].id ,atom["CH4"].id, ChargeNonpolar(...) );
+     *     pot.tabulate( atom["Na"].id ,atom["CH4"].id, 2.0, 20.0, 1e-5 ); // optional
+     *
+     * Pairs are dispatched through a dense `ntypes x ntypes` table indexed
+     * by particle id. Unrecognized pairs call `Tdefault` directly while
+     * added pairs call a `std::function` or, if tabulated with `tabulate()`,
+     * evaluate a `Ttabulator` spline inline within its range.
+     *
+     * @note Tabulation assumes that the added potential depends on the
+     *       particle types only, i.e. not on charges etc. that may change.
      */
-    template<typename Tdefault, typename Tparticle=PointParticle, typename Tdist=double>
+    template<typename Tdefault, typename Tparticle=PointParticle, typename Tdist=double, typename Ttabulator=Tabulate::Uniform<double> >
       class PotentialMap : public Tdefault {
         protected:
           typedef opair<int> Tpair;
           typedef std::function<double(const Tparticle&,const Tparticle&,Tdist)> Tfunc;
           typedef std::function<Point(const Tparticle&,const Tparticle&,double,const Point&)> Tforce;
-          std::map<Tpair,Tfunc> m;
-          std::map<Tpair,Tforce> mforce;
           std::string _info; // info for the added potentials (before turning into functors)
 
+          /** @brief Potential added for a pair of atom types */
+          struct Kernel {
+            AtomData::Tid id1, id2;
+            Tfunc f;
+            Tforce force;
+            bool splined;
+            typename Ttabulator::data table;
+          };
+          std::vector<Kernel> kernels; // added potentials
+          std::vector<int> cell;       // ntypes x ntypes; index in `kernels` or -1 for default
+          size_t ntypes;
+          Ttabulator tab;              // spline settings used by `spline()`
+
           // Force function object wrapper class
           template<class Tpairpot>
             struct ForceFunctionObject {
@@ -1808,9 +2095,69 @@ namespace Faunus {
               }
             };
 
+          /** @brief Index in `kernels` for a pair of ids or -1 if not added */
+          inline int kernel(size_t id1, size_t id2) const {
+            if (id1 < ntypes && id2 < ntypes)
+              return cell[id1*ntypes + id2];
+            return -1;
+          }
+
+          /** @brief Grow dispatch table to hold `n` atom types */
+          void resize(size_t n) {
+            if (n <= ntypes)
+              return;
+            std::vector<int> c(n*n, -1);
+            for (size_t i=0; i<ntypes; i++)
+              for (size_t j=0; j<ntypes; j++)
+                c[i*n+j] = cell[i*ntypes+j];
+            cell.swap(c);
+            ntypes = n;
+          }
+
+          inline double eval(const Kernel &k, const Tparticle &a, const Tparticle &b, double r2) const {
+            if (k.splined)
+              if (r2 > k.table.rmin2 && r2 < k.table.rmax2)
+                return tab.eval(k.table, r2);
+            return k.f(a,b,r2);
+          }
+
+          template<class T>
+            inline double eval(const Kernel &k, const Tparticle &a, const Tparticle &b, const T &r) const {
+              return k.f(a,b,r);
+            }
+
+          /**
+           * @brief Added potential between `id1` and `id2` as a function of r2
+           * @throw std::runtime_error if no potential has been added for the pair
+           */
+          std::function<double(double)> pairFunction(AtomData::Tid id1, AtomData::Tid id2) const {
+            int i = kernel(id1,id2);
+            if (i<0)
+              throw std::runtime_error("PotentialMap: cannot tabulate " + atom[id1].name
+                  + "<->" + atom[id2].name + " without an added potential");
+            Tparticle a, b;
+            a = atom[id1];
+            b = atom[id2];
+            Tfunc f = kernels[i].f;
+            return [=](double r2) { return f(a,b,r2); };
+          }
+
+          /** @brief Use `table` for the pair potential added between `id1` and `id2` */
+          void spline(AtomData::Tid id1, AtomData::Tid id2, const typename Ttabulator::data &table) {
+            Kernel &k = kernels.at(kernel(id1,id2));
+            k.table = table;
+            k.splined = true;
+          }
+
+          /** @brief Tabulate potential of added pair using current settings of `tab` */
+          void spline(AtomData::Tid id1, AtomData::Tid id2) {
+            spline(id1, id2, tab.generate(pairFunction(id1,id2)));
+          }
+
         public:
-          PotentialMap(Tmjson &j) : Tdefault(j) {
+          PotentialMap(Tmjson &j) : Tdefault(j), ntypes(0) {
             Tdefault::name += " (default)";
+            resize(atom.size());
           }
 
           /**
@@ -1821,22 +2168,45 @@ namespace Faunus {
             void add(AtomData::Tid id1, AtomData::Tid id2, Tpairpot pot) {
               pot.name=atom[id1].name + "<->" + atom[id2].name + ": " + pot.name;
               _info+="\n  " + pot.name + ":\n" + pot.info(20);
-              m[Tpair(id1,id2)] = pot;
-              mforce[Tpair(id1,id2)] = ForceFunctionObject<decltype(pot)>(pot);
+              resize(std::max(atom.size(), size_t(std::max(id1,id2))+1));
+              int i = kernel(id1,id2);
+              if (i<0) {
+                i = kernels.size();
+                kernels.push_back(Kernel());
+                cell[id1*ntypes + id2] = cell[id2*ntypes + id1] = i;
+              }
+              Kernel &k = kernels[i];
+              k.id1 = id1;
+              k.id2 = id2;
+              k.f = pot;
+              k.force = ForceFunctionObject<decltype(pot)>(pot);
+              k.splined = false;
             }
 
+          /**
+           * @brief Use a spline for the pair potential added between `id1` and `id2`
+           * @param rmin Minimum distance of spline; the added potential is used below
+           * @param rmax Maximum distance of spline; the added potential is used above
+           * @param utol Energy tolerance of spline (kT)
+           */
+          void tabulate(AtomData::Tid id1, AtomData::Tid id2, double rmin, double rmax, double utol) {
+            tab.setRange(rmin, rmax);
+            tab.setTolerance(utol);
+            spline(id1,id2);
+          }
+
           double operator()(const Tparticle &a, const Tparticle &b, const Tdist &r2) {
-            auto i=m.find( Tpair(a.id,b.id) );
-            if (i!=m.end())
-              return i->second(a,b,r2);
-            return Tdefault::operator()(a,b,r2);
+            int i = kernel(a.id, b.id);
+            if (i<0)
+              return Tdefault::operator()(a,b,r2);
+            return eval(kernels[i], a, b, r2);
           }
 
           Point force(const Tparticle &a, const Tparticle &b, double r2, const Point &p) {
-            auto i=mforce.find( Tpair(a.id,b.id) );
-            if (i!=mforce.end())
-              return i->second(a,b,r2,p);
-            return Tdefault::force(a,b,r2,p);
+            int i = kernel(a.id, b.id);
+            if (i<0)
+              return Tdefault::force(a,b,r2,p);
+            return kernels[i].force(a,b,r2,p);
           }
 
           std::string info(char w=20) {
@@ -1901,6 +2271,28 @@ namespace Faunus {
               return first(a,b,r2) + second(a,b,r2);
             }
 
+          /** @brief Energies in kT between `a` and a block of partners */
+          template<class Tparticle>
+            void batch(const Tparticle &a, const PairBlock &b, double *u) const {
+              double v[PairBlock::capacity];
+              for (int i=0; i<b.size; i+=PairBlock::capacity) {
+                int n = b.size-i;
+                PairBlock c = {b.r2+i, b.charge+i, b.radius+i, b.id+i,
+                  n < PairBlock::capacity ? n : PairBlock::capacity};
+                first.batch(a,c,u+i);
+                second.batch(a,c,v);
+                for (int k=0; k<c.size; k++)
+                  u[i+k] += v[k];
+              }
+            }
+
+          /** @brief Adds terms of `first` followed by terms of `second` to `u` */
+          template<class Tparticle>
+            void terms(const Tparticle &a, const Tparticle &b, double r2, double *u) const {
+              first.terms(a,b,r2,u);
+              second.terms(a,b,r2,u+homogeneous<T1>::size);
+            }
+
           template<typename Tparticle>
             Point force(const Tparticle &a, const Tparticle &b, double r2, const Point &p) {
               return first.force(a,b,r2,p) + second.force(a,b,r2,p);
@@ -1932,6 +2324,20 @@ namespace Faunus {
           }
       };
 
+    template<class T1, class T2>
+      struct is_batched<CombinedPairPotential<T1,T2>> :
+      public std::integral_constant<bool, is_batched<T1>::value && is_batched<T2>::value> {};
+
+    template<class T1, class T2>
+      struct homogeneous<CombinedPairPotential<T1,T2>> {
+        static const int size = (homogeneous<T1>::size > 0 && homogeneous<T2>::size > 0) ?
+          homogeneous<T1>::size + homogeneous<T2>::size : 0;
+        static constexpr int exponent( int k ) {
+          return k < homogeneous<T1>::size ?
+            homogeneous<T1>::exponent(k) : homogeneous<T2>::exponent(k-homogeneous<T1>::size);
+        }
+      };
+
     /**
      * @brief Creates a new pair potential with opposite sign
      */
@@ -0,0 +1,285 @@
+#ifndef FAU_SASA_H
+#define FAU_SASA_H
+
+#ifndef SWIG
+#include <faunus/common.h>
+#include <faunus/point.h>
+#include <faunus/physconst.h>
+#include <faunus/geometry.h>
+#endif
+
+namespace Faunus
+{
+
+  /** @brief Solvent accessible surface area (SASA) */
+  namespace SASA
+  {
+
+    /**
+     * @brief Approximately uniform points on the unit sphere (golden section spiral)
+     * @param n Number of points
+     */
+    inline std::vector<Point> spherePoints( int n )
+    {
+        std::vector<Point> v(n);
+        double inc = pc::pi * (3 - std::sqrt(5.0));
+        for ( int k = 0; k < n; k++ )
+        {
+            double z = 1 - (2 * k + 1) / double(n);
+            double r = std::sqrt(1 - z * z);
+            v[k] = Point(r * std::cos(k * inc), r * std::sin(k * inc), z);
+        }
+        return v;
+    }
+
+    /**
+     * @brief Incremental Shrake-Rupley surface areas
+     *
+     * Each particle, `i`, is represented by a sphere of radius `radius+probe`
+     * covered by a fixed set of points. The accessible area of `i` is the
+     * sphere area times the fraction of points not buried inside any
+     * overlapping neighbor. Areas of an accepted particle vector are kept
+     * per particle together with a `Geometry::CellList` with cells no
+     * smaller than the largest sphere diameter.
+     *
+     * When a few particles move, `trial()` recalculates only the moved
+     * particles and the neighbors overlapping with either their old or new
+     * positions; `accept()` copies the new areas and re-bins the moved
+     * particles. Distances are calculated by the geometry so periodic
+     * boundaries are respected.
+     *
+     * Example:
+     *
+     * ~~~{.cpp}
+     * SASA::ShrakeRupley sasa( 1.4 );          // probe radius
+     * sasa.build( spc.geo, spc.p );            // all areas
+     * sasa.trial( spc.geo, spc.p, spc.trial, {5} ); // particle 5 moved
+     * sasa.accept( spc.trial );
+     * ~~~
+     */
+    class ShrakeRupley
+    {
+    private:
+        double probe;                   // probe radius
+        double rmax;                    // largest sphere radius in grid
+        std::vector<Point> points;      // points on unit sphere
+        std::vector<double> area;       // area of each particle (accepted vector)
+        Geometry::CellList grid;        // cell list of accepted vector
+        std::vector<Point> nbvec;       // scratch: neighbor vectors
+        std::vector<double> nbr2;       // scratch: squared neighbor radii
+
+        std::vector<int> affected;      // particles with new areas in trial
+        std::vector<double> trialarea;  // new areas of `affected`
+        std::vector<char> isAffected, isMoved;
+        std::vector<int> movedList;
+
+        template<class Tparticle>
+        inline double radius( const Tparticle &a ) const { return a.radius + probe; }
+
+        /** @brief Area of `i` given the neighbor vectors and radii in `nbvec`, `nbr2` */
+        double exposed( double R )
+        {
+            size_t n = nbvec.size(), last = 0, cnt = 0;
+            for ( auto &s : points )
+            {
+                Point x = R * s;
+                bool buried = false;
+                if ( n > 0 && (x - nbvec[last]).squaredNorm() < nbr2[last] )
+                    buried = true; // neighbor that buried the previous point
+                else
+                    for ( size_t j = 0; j < n; j++ )
+                        if ( (x - nbvec[j]).squaredNorm() < nbr2[j] )
+                        {
+                            last = j;
+                            buried = true;
+                            break;
+                        }
+                if ( !buried )
+                    cnt++;
+            }
+            return 4 * pc::pi * R * R * cnt / double(points.size());
+        }
+
+        /** @brief Collect neighbor `j` of `i` if spheres overlap */
+        template<class Tgeometry, class Tpvec>
+        inline void addNeighbor( Tgeometry &geo, const Tpvec &p, int i, int j, double Ri )
+        {
+            if ( i == j )
+                return;
+            double Rj = radius(p[j]);
+            Point d = geo.vdist(p[j], p[i]);
+            if ( d.squaredNorm() < (Ri + Rj) * (Ri + Rj))
+            {
+                nbvec.push_back(d);
+                nbr2.push_back(Rj * Rj);
+            }
+        }
+
+        template<class Tgeometry, class Tparticle>
+        inline bool overlap( Tgeometry &geo, const Tparticle &a, const Tparticle &b ) const
+        {
+            double R = radius(a) + radius(b);
+            return geo.sqdist(a, b) < R * R;
+        }
+
+        void mark( int i )
+        {
+            if ( !isAffected[i] )
+            {
+                isAffected[i] = 1;
+                affected.push_back(i);
+            }
+        }
+
+    public:
+        /**
+         * @param probe_A Probe radius (angstrom)
+         * @param npoints Number of surface points per particle
+         */
+        ShrakeRupley( double probe_A = 1.4, int npoints = 400 ) : probe(probe_A), rmax(0)
+        {
+            if ( npoints < 1 )
+                throw std::runtime_error("SASA: number of surface points must be positive");
+            points = spherePoints(npoints);
+        }
+
+        double probeRadius() const { return probe; }
+
+        size_t numPoints() const { return points.size(); }
+
+        /** @brief Accessible area of particle `i` in vector `p` using all other particles (N-squared) */
+        template<class Tgeometry, class Tpvec>
+        double areaOf( Tgeometry &geo, const Tpvec &p, int i )
+        {
+            double Ri = radius(p[i]);
+            nbvec.clear();
+            nbr2.clear();
+            for ( int j = 0; j < int(p.size()); j++ )
+                addNeighbor(geo, p, i, j, Ri);
+            return exposed(Ri);
+        }
+
+        /** @brief Calculate areas of all particles and bin them in grid */
+        template<class Tgeometry, class Tpvec>
+        void build( Tgeometry &geo, const Tpvec &p )
+        {
+            rmax = 0;
+            for ( auto &a : p )
+                rmax = std::max(rmax, radius(a));
+            double rc = std::max(2 * rmax, 1e-6);
+            Point len = geo.len;
+            if ( !(len.minCoeff() > 0 && len.allFinite()))
+                len = Point(rc, rc, rc); // no box: single cell
+            grid.setup(len, rc);
+            grid.build(p);
+            area.resize(p.size());
+            for ( size_t i = 0; i < p.size(); i++ )
+            {
+                double Ri = radius(p[i]);
+                nbvec.clear();
+                nbr2.clear();
+                grid.forEachNeighbor(p[i], [&]( int j ) { addNeighbor(geo, p, int(i), j, Ri); });
+                area[i] = exposed(Ri);
+            }
+            isAffected.assign(p.size(), 0);
+            isMoved.assign(p.size(), 0);
+            affected.clear();
+            trialarea.clear();
+            movedList.clear();
+        }
+
+        /** @brief Number of particles in grid */
+        size_t size() const { return area.size(); }
+
+        /** @brief Areas of accepted vector (angstrom^2) */
+        const std::vector<double> &areas() const { return area; }
+
+        /** @brief Total area of accepted vector (angstrom^2) */
+        double total() const { return std::accumulate(area.begin(), area.end(), 0.0); }
+
+        /**
+         * @brief Calculate new areas due to moved particles
+         * @param geo Geometry
+         * @param p Accepted particle vector, as passed to `build()`
+         * @param trial Trial particle vector, identical to `p` except for `moved`
+         * @param moved Indices of moved particles
+         * @return False if the grid cannot be used, i.e. a moved sphere grew larger than the cell size.
+         *
+         * The recalculated particles and their new areas are given by `changed()` and `changedAreas()`.
+         */
+        template<class Tgeometry, class Tpvec>
+        bool trial( Tgeometry &geo, const Tpvec &p, const Tpvec &trial, const std::vector<int> &moved )
+        {
+            reject();
+            for ( auto m : moved )
+                if ( radius(trial[m]) > rmax )
+                    return false;
+            for ( auto m : moved )
+                if ( !isMoved[m] )
+                {
+                    isMoved[m] = 1;
+                    movedList.push_back(m);
+                    mark(m);
+                }
+            for ( auto m : movedList )
+            {   // static neighbors overlapping old or new position
+                grid.forEachNeighbor(p[m], [&]( int j ) {
+                    if ( !isMoved[j] && overlap(geo, p[j], p[m]))
+                        mark(j);
+                });
+                grid.forEachNeighbor(trial[m], [&]( int j ) {
+                    if ( !isMoved[j] && overlap(geo, trial[j], trial[m]))
+                        mark(j);
+                });
+            }
+            trialarea.resize(affected.size());
+            for ( size_t k = 0; k < affected.size(); k++ )
+            {
+                int i = affected[k];
+                double Ri = radius(trial[i]);
+                nbvec.clear();
+                nbr2.clear();
+                grid.forEachNeighbor(trial[i], [&]( int j ) {
+                    if ( !isMoved[j] )
+                        addNeighbor(geo, trial, i, j, Ri);
+                });
+                for ( auto j : movedList )
+                    addNeighbor(geo, trial, i, j, Ri);
+                trialarea[k] = exposed(Ri);
+            }
+            return true;
+        }
+
+        /** @brief Particles recalculated by last `trial()` */
+        const std::vector<int> &changed() const { return affected; }
+
+        /** @brief New areas of `changed()` particles */
+        const std::vector<double> &changedAreas() const { return trialarea; }
+
+        /** @brief Keep areas from last `trial()`; `trial` is the now accepted vector */
+        template<class Tpvec>
+        void accept( const Tpvec &trial )
+        {
+            for ( size_t k = 0; k < affected.size(); k++ )
+                area[affected[k]] = trialarea[k];
+            for ( auto m : movedList )
+                grid.move(m, trial[m]);
+            reject();
+        }
+
+        /** @brief Discard areas from last `trial()` */
+        void reject()
+        {
+            for ( auto i : affected )
+                isAffected[i] = 0;
+            for ( auto i : movedList )
+                isMoved[i] = 0;
+            affected.clear();
+            trialarea.clear();
+            movedList.clear();
+        }
+    };
+
+  }//namespace SASA
+}//namespace Faunus
+#endif
@@ -2,13 +2,157 @@
 #define FAU_slump_h
 
 #include <random>
+#include <array>
+#include <cstdint>
 #include <faunus/json.h>
 #include <faunus/textio.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 /// @brief Namespace for Faunus
 namespace Faunus
 {
 
+  /**
+   * @brief Counter-based Philox4x32-10 random bit generator
+   *
+   * Each 128 bit output block is a keyed bijection of a counter so that the
+   * generator state is merely a counter and a key. The key is formed by the
+   * seed while the upper half of the counter holds a _stream_ number, meaning
+   * that any number of independent, reproducible streams can be split from a
+   * single seed without communication or locking. Satisfies the
+   * `UniformRandomBitGenerator` concept and can thus be used with
+   * `RandomTwister` as well as with the standard library distributions.
+   *
+   * ~~~{.cpp}
+   * Philox4x32 a(42, 0), b(42, 1); // two independent streams of seed 42
+   * RandomTwister<double, Philox4x32> ran;
+   * ~~~
+   *
+   * Reference: doi:10/bnhgg6
+   */
+  class Philox4x32
+  {
+  public:
+      typedef std::uint32_t result_type;
+
+  private:
+      typedef std::array<result_type, 4> Tblock;
+      Tblock ctr;                      // counter (0,1: block number, 2,3: stream)
+      Tblock buf;                      // current output block
+      std::array<result_type, 2> key;  // seed
+      unsigned int idx;                // next word in output block
+
+      static inline result_type mulhilo( result_type a, result_type b, result_type &hi )
+      {
+          std::uint64_t p = std::uint64_t(a) * b;
+          hi = result_type(p >> 32);
+          return result_type(p);
+      }
+
+      void generate()
+      {
+          Tblock x = ctr;
+          std::array<result_type, 2> k = key;
+          for ( int r = 0; r < 10; r++ )
+          {
+              result_type hi0, hi1;
+              result_type lo0 = mulhilo(0xD2511F53, x[0], hi0);
+              result_type lo1 = mulhilo(0xCD9E8D57, x[2], hi1);
+              x = {{hi1 ^ x[1] ^ k[0], lo1, hi0 ^ x[3] ^ k[1], lo0}};
+              k[0] += 0x9E3779B9;
+              k[1] += 0xBB67AE85;
+          }
+          buf = x;
+          if ( ++ctr[0] == 0 )  // 64 bit block counter
+              ++ctr[1];
+          idx = 0;
+      }
+
+  public:
+      static constexpr result_type min() { return 0; }
+
+      static constexpr result_type max() { return 0xFFFFFFFF; }
+
+      /** @brief Construct from seed and stream number */
+      explicit Philox4x32( std::uint64_t s = 5489u, std::uint64_t stream = 0 )
+      {
+          seed(s);
+          setStream(stream);
+      }
+
+      /** @brief Set key and rewind to beginning of stream */
+      void seed( std::uint64_t s = 5489u )
+      {
+          key = {{result_type(s), result_type(s >> 32)}};
+          ctr[0] = ctr[1] = 0;
+          idx = 4;
+      }
+
+      /** @brief Select stream and rewind to beginning of it */
+      void setStream( std::uint64_t stream )
+      {
+          ctr = {{0, 0, result_type(stream), result_type(stream >> 32)}};
+          idx = 4;
+      }
+
+      result_type operator()()
+      {
+          if ( idx == 4 )
+              generate();
+          return buf[idx++];
+      }
+
+      /** @brief Skip `z` numbers in constant time */
+      void discard( unsigned long long z )
+      {
+          while ( z > 0 && idx < 4 )
+          {
+              idx++;
+              z--;
+          }
+          std::uint64_t n = (std::uint64_t(ctr[1]) << 32 | ctr[0]) + z / 4;
+          ctr[0] = result_type(n);
+          ctr[1] = result_type(n >> 32);
+          if ( z % 4 != 0 )
+          {
+              generate();
+              idx = z % 4;
+          }
+      }
+
+      bool operator==( const Philox4x32 &o ) const
+      {
+          return key == o.key && ctr == o.ctr && idx == o.idx && (idx == 4 || buf == o.buf);
+      }
+
+      bool operator!=( const Philox4x32 &o ) const { return !(*this == o); }
+
+      friend std::ostream &operator<<( std::ostream &o, const Philox4x32 &e )
+      {
+          o << e.key[0] << " " << e.key[1];
+          for ( auto i : e.ctr )
+              o << " " << i;
+          return o << " " << e.idx;
+      }
+
+      friend std::istream &operator>>( std::istream &in, Philox4x32 &e )
+      {
+          unsigned int idx;
+          in >> e.key[0] >> e.key[1] >> e.ctr[0] >> e.ctr[1] >> e.ctr[2] >> e.ctr[3] >> idx;
+          if ( idx < 4 )
+          {   // regenerate current block
+              if ( e.ctr[0]-- == 0 )
+                  e.ctr[1]--;
+              e.generate();
+          }
+          e.idx = idx;
+          return in;
+      }
+  };
+
   /**
    * @brief Mersenne Twister Random number generator for uniform distribution
    * @date Lund, 2010
@@ -20,8 +164,12 @@ namespace Faunus
    * `std::random_device`.
    * @note See http://www.pcg-random.org/posts/ease-of-use-without-loss-of-power.html for some interesting stuff about
            random numbers in C++11.
+   *
+   * If `locked=true` (default) draws are protected by an OpenMP critical
+   * section so that a single instance may be shared between threads. Thread
+   * private generators should set `locked=false`; see `RandomStreams`.
    */
-  template<typename T=double, typename Tengine=std::mt19937>
+  template<typename T=double, typename Tengine=std::mt19937, bool locked=true>
   class RandomTwister
   {
 
@@ -88,6 +236,8 @@ namespace Faunus
       {
           if ( discard > 0 )
               eng.discard(discard);
+          if ( !locked )
+              return dist(eng);
           T x;
 #pragma omp critical
           x = dist(eng);
@@ -123,6 +273,72 @@ namespace Faunus
       }
   };
 
+  /**
+   * @brief Independent, lock-free random number streams split from a single seed
+   *
+   * Holds one unlocked `RandomTwister` per stream, each using a distinct
+   * `Philox4x32` stream of the same seed. The function operator returns the
+   * stream of the calling OpenMP thread so that parallel regions can draw
+   * random numbers without contention, while streams may also be assigned to
+   * e.g. individual moves via `operator[]`. For a given seed and number of
+   * streams the sequences are reproducible.
+   *
+   * ~~~{.cpp}
+   * RandomStreams<> ran(42);      // one stream per OpenMP thread
+   * #pragma omp parallel for
+   * for (int i=0; i<n; i++)
+   *   x[i] = ran()();             // thread private stream
+   * ~~~
+   */
+  template<typename T=double>
+  class RandomStreams
+  {
+  public:
+      typedef RandomTwister<T, Philox4x32, false> Tstream;
+
+  private:
+      std::vector<Tstream> streams;
+
+  public:
+      /**
+       * @param s Seed
+       * @param n Number of streams (default: max. number of OpenMP threads)
+       */
+      RandomStreams( std::uint64_t s = 5489u, size_t n = 0 ) { seed(s, n); }
+
+      /** @brief Reset all streams from seed */
+      void seed( std::uint64_t s, size_t n = 0 )
+      {
+          if ( n == 0 )
+          {
+#ifdef _OPENMP
+              n = omp_get_max_threads();
+#else
+              n = 1;
+#endif
+          }
+          streams.resize(n);
+          for ( size_t k = 0; k < n; k++ )
+              streams[k].eng = Philox4x32(s, k);
+      }
+
+      /** @brief Stream of calling thread */
+      Tstream &operator()()
+      {
+#ifdef _OPENMP
+          size_t k = omp_get_thread_num();
+          assert(k < streams.size() && "more threads than streams");
+          return streams[k];
+#else
+          return streams.front();
+#endif
+      }
+
+      Tstream &operator[]( size_t k ) { return streams.at(k); } //!< k'th stream
+
+      size_t size() const { return streams.size(); }            //!< Number of streams
+  };
+
   extern RandomTwister<> slump;
 
 } // namespace
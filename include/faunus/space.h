@@ -14,6 +14,7 @@
 #include <faunus/textio.h>
 #include <faunus/io.h>
 #include <faunus/molecule.h>
+#include <unordered_map>
 
 #endif
 
@@ -216,6 +217,175 @@ namespace Faunus
 
   };
 
+  /**
+   * @brief Flat, sorted map that keeps its memory when cleared
+   *
+   * Drop-in for the subset of `std::map<Tkey,T>` used by `Space::Change`:
+   * `operator[]`, `count`, `find`, `erase` and ordered iteration over
+   * `std::pair<Tkey,T>`. Entries are stored contiguously and sorted by key.
+   * `clear()` only resets the number of used slots so that neither the
+   * slots nor the containers they hold (`T` must provide `clear()`) are
+   * freed. A map reused for every Monte Carlo move therefore stops
+   * allocating once it has seen the largest change.
+   */
+  template<class T, class Tkey=int>
+  class ChangeMap
+  {
+  public:
+      typedef std::pair<Tkey, T> value_type;
+      typedef typename std::vector<value_type>::iterator iterator;
+      typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+  private:
+      std::vector<value_type> slots; // first `n` are in use
+      size_t n = 0;
+
+      struct keyLess
+      {
+          bool operator()( const value_type &a, const Tkey &key ) const { return a.first < key; }
+      };
+
+  public:
+      ChangeMap() {}
+
+      ChangeMap( std::initializer_list<value_type> l )
+      {
+          for ( auto &m : l )
+              operator[](m.first) = m.second;
+      }
+
+      ChangeMap( const ChangeMap &other ) { *this = other; }
+
+      /** @brief Copy used slots only, reusing existing capacity */
+      ChangeMap &operator=( const ChangeMap &other )
+      {
+          if ( this != &other )
+          {
+              if ( slots.size() < other.n )
+                  slots.resize(other.n);
+              std::copy(other.begin(), other.end(), slots.begin());
+              n = other.n;
+          }
+          return *this;
+      }
+
+      iterator begin() { return slots.begin(); }
+      iterator end() { return slots.begin() + n; }
+      const_iterator begin() const { return slots.begin(); }
+      const_iterator end() const { return slots.begin() + n; }
+
+      size_t size() const { return n; }
+      bool empty() const { return n == 0; }
+      void clear() { n = 0; }
+
+      iterator find( const Tkey &key )
+      {
+          auto it = std::lower_bound(begin(), end(), key, keyLess());
+          return (it != end() && it->first == key) ? it : end();
+      }
+
+      const_iterator find( const Tkey &key ) const
+      {
+          auto it = std::lower_bound(begin(), end(), key, keyLess());
+          return (it != end() && it->first == key) ? it : end();
+      }
+
+      size_t count( const Tkey &key ) const { return find(key) != end() ? 1 : 0; }
+
+      const T &at( const Tkey &key ) const
+      {
+          auto it = find(key);
+          if ( it == end())
+              throw std::out_of_range("ChangeMap: key not found");
+          return it->second;
+      }
+
+      /** @brief Access or insert (empty) element with given key */
+      T &operator[]( const Tkey &key )
+      {
+          auto it = std::lower_bound(begin(), end(), key, keyLess());
+          if ( it != end() && it->first == key )
+              return it->second;
+          size_t pos = it - begin();
+          if ( n == slots.size())
+              slots.emplace_back();
+          slots[n].first = key;
+          slots[n].second.clear();
+          std::rotate(slots.begin() + pos, slots.begin() + n, slots.begin() + n + 1);
+          n++;
+          return slots[pos].second;
+      }
+
+      /** @brief Remove element with given key; its slot is kept for reuse */
+      size_t erase( const Tkey &key )
+      {
+          auto it = find(key);
+          if ( it == end())
+              return 0;
+          std::rotate(it, it + 1, end());
+          n--;
+          return 1;
+      }
+  };
+
+  /**
+   * @brief Structure-of-arrays mirror of a particle vector
+   *
+   * Positions, charges, radii and atom ids are stored in separate, contiguous
+   * arrays so that pair kernels can stream through e.g. `x.data()`
+   * without touching the remaining particle properties. Kept in sync with
+   * `Space::p` and `Space::trial` via `Space::enableArrays()`.
+   */
+  struct ParticleArrays
+  {
+      std::vector<double> x, y, z, charge, radius;
+      std::vector<int> id;
+
+      size_t size() const { return x.size(); }
+
+      void resize( size_t n )
+      {
+          x.resize(n);
+          y.resize(n);
+          z.resize(n);
+          charge.resize(n);
+          radius.resize(n);
+          id.resize(n);
+      }
+
+      /** @brief Copy i'th particle */
+      template<class Tparticle>
+      void set( size_t i, const Tparticle &a )
+      {
+          x[i] = a.x();
+          y[i] = a.y();
+          z[i] = a.z();
+          charge[i] = a.charge;
+          radius[i] = a.radius;
+          id[i] = a.id;
+      }
+
+      /** @brief Copy i'th element from other mirror */
+      void set( size_t i, const ParticleArrays &o )
+      {
+          x[i] = o.x[i];
+          y[i] = o.y[i];
+          z[i] = o.z[i];
+          charge[i] = o.charge[i];
+          radius[i] = o.radius[i];
+          id[i] = o.id[i];
+      }
+
+      /** @brief Copy all particles */
+      template<class Tpvec>
+      void sync( const Tpvec &p )
+      {
+          resize(p.size());
+          for ( size_t i = 0; i < p.size(); i++ )
+              set(i, p[i]);
+      }
+  };
+
   /**
    * @brief Placeholder for particles and groups
    *
@@ -255,6 +425,41 @@ namespace Faunus
       std::vector<Group *> g;                 //!< Pointers to ALL groups in the system
       Tmjson to_json();
 
+      std::vector<int> groupOfParticle;                    //!< Particle index -> index in `g` (-1 if none)
+      std::unordered_map<const Group *, int> indexOfGroup; //!< Group pointer -> index in `g`
+
+      /** @brief Rebuild particle -> group and group -> index lookup tables */
+      void initLookup()
+      {
+          groupOfParticle.assign(p.size(), -1);
+          indexOfGroup.clear();
+          for ( int k = int(g.size()) - 1; k >= 0; k-- ) // first group wins if groups overlap
+          {
+              indexOfGroup[g[k]] = k;
+              for ( auto i : *g[k] )
+                  if ( i >= 0 && i < (int) groupOfParticle.size())
+                      groupOfParticle[i] = k;
+          }
+      }
+
+      /** @brief True if lookup tables cover current particles and groups */
+      bool lookupInSync() const
+      {
+          return groupOfParticle.size() == p.size() && indexOfGroup.size() == g.size();
+      }
+
+      /** @brief Decrement group indices above `k` after removing `g[k]` */
+      void lookupEraseGroup( int k )
+      {
+          indexOfGroup.erase(g[k]);
+          for ( auto &j : groupOfParticle )
+              if ( j > k )
+                  j--;
+          for ( auto &m : indexOfGroup )
+              if ( m.second > k )
+                  m.second--;
+      }
+
   public:
       typedef std::vector<Tparticle, Eigen::aligned_allocator<Tparticle> > p_vec;
       typedef p_vec ParticleVector;          //!< Particle vector type
@@ -274,6 +479,9 @@ namespace Faunus
       Tracker<int> atomTrack;                //!< Track atom index based on atom type
       Tracker<Group *> molTrack;              //!< Track groups pointers based on molecule type
 
+      ParticleArrays arrays_p;               //!< SoA mirror of `p` (if enabled)
+      ParticleArrays arrays_trial;           //!< SoA mirror of `trial` (if enabled)
+
       /**
        * @brief Struct for specifying changes to be made to Space
        *
@@ -283,16 +491,19 @@ namespace Faunus
        * given index vector is *empty*, it is assumed that all particles
        * in the groups have been altered.
        * For `inGroup` the map index refers to the Molecule id to insert.
+       *
+       * The maps are `ChangeMap`s which retain their memory on `clear()`
+       * so that a `Change` reused between moves does not allocate.
        */
       struct Change
       {
           double dV;  // volume change
           bool geometryChange;
-          std::map<int, vector<int>> mvGroup; // move groups
-          std::map<int, vector<int>> rmGroup; // remove groups
-          std::map<int, ParticleVector> inGroup; // insert groups
+          ChangeMap<vector<int>> mvGroup; // move groups
+          ChangeMap<vector<int>> rmGroup; // remove groups
+          ChangeMap<ParticleVector> inGroup; // insert groups
 
-          Change() : dV(0) {};
+          Change() : dV(0), geometryChange(false) {};
 
           void clear()
           {
@@ -321,7 +532,7 @@ namespace Faunus
       void applyChange( const Change &c )
       {
           // loop over moved groups
-          for ( auto m : c.mvGroup )
+          for ( auto &m : c.mvGroup )
           {
               auto g = groupList()[m.first];
               if ( m.second.empty()) // no index given; assume all have changed
@@ -345,6 +556,93 @@ namespace Faunus
           assert(!"incomplete");
       }
 
+  private:
+      bool useArrays = false;
+
+      /** @brief Call `f(i)` for all particles in change; false if change is empty or not index based */
+      template<class Tfunc>
+      bool forEachChanged( const Change &c, Tfunc f )
+      {
+          if ( c.empty() || !c.rmGroup.empty() || !c.inGroup.empty())
+              return false;
+          for ( auto &m : c.mvGroup )
+              if ( m.second.empty())
+                  for ( auto i : *g.at(m.first))
+                      f(i);
+              else
+                  for ( auto i : m.second )
+                      f(i);
+          return true;
+      }
+
+  public:
+      /**
+       * @brief Enable or disable structure-of-arrays mirrors of `p` and `trial`
+       *
+       * When enabled, `arrays_p` and `arrays_trial` are kept in sync
+       * with the particle vectors by the Monte Carlo moves which call
+       * `syncArrays(Change)` after generating a trial configuration and
+       * `acceptArrays()` or `undoArrays()` afterwards. Code that modifies
+       * particles outside of moves must call `syncArrays()`.
+       */
+      void enableArrays( bool b = true )
+      {
+          useArrays = b;
+          if ( useArrays )
+              syncArrays();
+          else
+          {
+              arrays_p = ParticleArrays();
+              arrays_trial = ParticleArrays();
+          }
+      }
+
+      bool hasArrays() const { return useArrays; } //!< True if SoA mirrors are enabled
+
+      /** @brief SoA mirror of `p` or `trial` */
+      const ParticleArrays &arrays( const ParticleVector &v ) const
+      {
+          assert(useArrays && (&v == &p || &v == &trial));
+          return (&v == &trial) ? arrays_trial : arrays_p;
+      }
+
+      /** @brief Copy all particles to SoA mirrors */
+      void syncArrays()
+      {
+          if ( useArrays )
+          {
+              arrays_p.sync(p);
+              arrays_trial.sync(trial);
+          }
+      }
+
+      /** @brief Copy trial particles in change to `arrays_trial` */
+      void syncArrays( const Change &c )
+      {
+          if ( useArrays )
+              if ( arrays_trial.size() != trial.size()
+                  || !forEachChanged(c, [&]( int i ) { arrays_trial.set(i, trial[i]); }))
+                  syncArrays();
+      }
+
+      /** @brief Accept change in SoA mirrors, i.e. copy `arrays_trial` to `arrays_p` */
+      void acceptArrays( const Change &c )
+      {
+          if ( useArrays )
+              if ( arrays_p.size() != p.size() || arrays_trial.size() != trial.size()
+                  || !forEachChanged(c, [&]( int i ) { arrays_p.set(i, arrays_trial); }))
+                  syncArrays();
+      }
+
+      /** @brief Reject change in SoA mirrors, i.e. copy `arrays_p` to `arrays_trial` */
+      void undoArrays( const Change &c )
+      {
+          if ( useArrays )
+              if ( arrays_p.size() != p.size() || arrays_trial.size() != trial.size()
+                  || !forEachChanged(c, [&]( int i ) { arrays_trial.set(i, arrays_p); }))
+                  syncArrays();
+      }
+
       /**
        * @brief Constructor
        *
@@ -381,6 +679,7 @@ namespace Faunus
 
       bool insert( const Tparticle &, int= -1 ); //!< Insert particle at pos n (old n will be pushed forward).
       bool erase( int );             //!< Remove n'th particle and downshift/remove groups
+      bool eraseSwap( int );         //!< Remove n'th particle by moving last particle of its atomic group into its place
       bool eraseGroup( int );        //!< Remove n'th group as well as its particles
       void reserve( int );           //!< Reserve space for particles for better memory efficiency
       string info();               //!< Information string
@@ -410,30 +709,52 @@ namespace Faunus
               for ( auto i : *g )
                   atomTrack.insert(p.at(i).id, i);
           }
+          initLookup();
       }
 
       /**
        * @brief Find which group given particle index belongs to.
        *
-       * If not found, `nullptr` is returned.
+       * If not found, `nullptr` is returned. The lookup is O(1) using a
+       * table maintained by `insert()`, `erase()` and `eraseGroup()`.
+       * Should the table be stale, e.g. after adding groups directly to
+       * `groupList()`, it is rebuilt. Group ranges modified outside of
+       * `Space` require a call to `initTracker()`.
        */
       inline Group *findGroup( int i )
       {
-          for ( auto g : groupList())
-              if ( g->find(i))
-                  return g;
+          if ( i >= 0 && i < (int) groupOfParticle.size())
+          {
+              int k = groupOfParticle[i];
+              if ( k >= 0 && k < (int) g.size() && g[k]->find(i))
+                  return g[k];
+              if ( k < 0 && lookupInSync())
+                  return nullptr;
+          }
+          initLookup();
+          if ( i >= 0 && i < (int) groupOfParticle.size() && groupOfParticle[i] >= 0 )
+              return g[groupOfParticle[i]];
           return nullptr;
       }
 
       /**
        * @brief Find group index for given group pointer.
        *
-       * If not found, `-1` is returned.
+       * If not found, `-1` is returned. O(1), see `findGroup()`.
        */
       inline int findIndex( Group *group )
       {
-          auto it = std::find(g.begin(), g.end(), group);
-          return (it != g.end()) ? it - g.begin() : -1;
+          auto it = indexOfGroup.find(group);
+          if ( it != indexOfGroup.end())
+          {
+              if ( it->second < (int) g.size() && g[it->second] == group )
+                  return it->second;
+          }
+          else if ( lookupInSync())
+              return -1;
+          initLookup();
+          it = indexOfGroup.find(group);
+          return (it != indexOfGroup.end()) ? it->second : -1;
       }
 
       /**
@@ -622,13 +943,19 @@ namespace Faunus
 
       atomTrack.insert(a.id, i);
 
-      for ( auto gj : g )
+      int k = -1; // group now holding i
+      for ( size_t j = 0; j < g.size(); j++ )
       {
+          auto gj = g[j];
           if ( gj->front() > i )
               gj->setfront(gj->front() + 1); // gj->beg++;
           if ( gj->back() >= i )
               gj->setback(gj->back() + 1);    //gj->last++; // +1 is a special case for adding to the end of p-vector
+          if ( k < 0 && gj->find(i))
+              k = j;
       }
+      if ( (size_t) i <= groupOfParticle.size())
+          groupOfParticle.insert(groupOfParticle.begin() + i, k);
       return true;
   }
 
@@ -643,6 +970,8 @@ namespace Faunus
           atomTrack.erase(p[i].id, i);
           p.erase(p.begin() + i);
           trial.erase(trial.begin() + i);
+          if ( i < (int) groupOfParticle.size())
+              groupOfParticle.erase(groupOfParticle.begin() + i);
 
           Group *is_empty = nullptr;
           for ( auto gj : g )
@@ -658,21 +987,53 @@ namespace Faunus
           if ( is_empty != nullptr )
           { // remove empty group
               molTrack.erase(is_empty->molId, is_empty);
-              g.erase(g.begin() + findIndex(is_empty));
+              int k = findIndex(is_empty);
+              lookupEraseGroup(k);
+              g.erase(g.begin() + k);
               delete (is_empty);
           }
 
           // down-shift all particle index above i
-          for ( auto &m : atomTrack.getMap() )
-              for ( auto &j : m.second )
-                  if ( j > i )
-                      j--;
+          if ( i < (int) p.size())
+              for ( auto &m : atomTrack.getMap() )
+                  for ( auto &j : m.second )
+                      if ( j > i )
+                          j--;
 
           return true;
       }
       return false;
   }
 
+  /**
+   * @param i Particle to remove
+   *
+   * If `i` belongs to an atomic group, the last particle of the group is
+   * copied into slot `i` and the end of the group is removed with
+   * `erase()`. For the last group in the particle vector (typically a
+   * grand canonical salt group) no other particles, groups or tracker
+   * entries are shifted and removal is O(1) apart from the atom tracker.
+   * The order of particles within the group is not preserved.
+   * Particles in molecular groups are removed with `erase()`.
+   */
+  template<class Tgeometry, class Tparticle>
+  bool Space<Tgeometry, Tparticle>::eraseSwap( int i )
+  {
+      assert(i >= 0 && i < (int) p.size());
+      Group *gi = findGroup(i);
+      if ( gi == nullptr || !gi->isAtomic())
+          return erase(i);
+      int last = gi->back();
+      if ( last != i )
+      {
+          atomTrack.erase(p[i].id, i);
+          atomTrack.insert(p[last].id, i); // `last` is removed from tracker by erase()
+          p[i] = p[last];
+          trial[i] = trial[last];
+      }
+      return erase(last);
+  }
+
   /**
    * This will remove the specified group (given as index in `groupList()`)
    * from the space. Later groups will be shuffled down.
@@ -709,6 +1070,11 @@ namespace Faunus
                   for ( auto i : *gi )
                       atomTrack.erase(p[i].id, i);
 
+          // erase group and its particles from lookup tables
+          if ( (size_t) end < groupOfParticle.size())
+              groupOfParticle.erase(groupOfParticle.begin() + beg, groupOfParticle.begin() + end + 1);
+          lookupEraseGroup(i);
+
           // erase group from: memory; grouplist; particle vectors
           delete (g[i]);
           g.erase(g.begin() + i);
@@ -967,28 +1333,30 @@ namespace Faunus
               // group exists -- now add particles
               if ( imax >= 0 )
               {
+                  int first = g[imax]->back() + 1; // first inserted index
+                  int n = pin.size();
+
+                  // push forward tracked index of particles beyond insertion point
+                  if ( first < (int) p.size())
+                      for ( auto &m : atomTrack.getMap() )
+                          for ( auto &j : m.second )
+                              if ( j >= first )
+                                  j += n;
+
                   // add to particle vectors
-                  p.insert(p.begin() + g[imax]->back() + 1, pin.begin(), pin.end());
-                  trial.insert(trial.begin() + g[imax]->back() + 1, pin.begin(), pin.end());
-                  g[imax]->setback(g[imax]->back() + pin.size());
+                  p.insert(p.begin() + first, pin.begin(), pin.end());
+                  trial.insert(trial.begin() + first, pin.begin(), pin.end());
+                  if ( (size_t) first <= groupOfParticle.size())
+                      groupOfParticle.insert(groupOfParticle.begin() + first, n, imax);
+                  g[imax]->setback(g[imax]->back() + n);
 
                   // push forward groups above
                   for ( auto i : g )
-                  {
-                      if ( *i > *g[imax] )
-                      {
-                          // erase index from atom tracker
-                          for ( auto ndx : *i )
-                              atomTrack.erase(p[ndx].id, ndx);
-                          // shift upwards
-                          i->shift(pin.size());
-                          // add updated index to atom tracker
-                          for ( auto ndx : *i )
-                              atomTrack.insert(p[ndx].id, ndx);
-                      }
-                  }
-                  // add to atom tracker
-                  for ( auto i : *g[imax] )
+                      if ( i != g[imax] && i->front() >= first )
+                          i->shift(n);
+
+                  // add inserted particles to atom tracker
+                  for ( int i = first; i < first + n; i++ )
                       atomTrack.insert(p[i].id, i);
 
                   assert(atomTrack.size() == p.size());
@@ -1007,6 +1375,9 @@ namespace Faunus
 
           // add group and particles
           groupList().push_back(x);
+          if ( groupOfParticle.size() == p.size())
+              groupOfParticle.insert(groupOfParticle.end(), pin.size(), int(g.size()) - 1);
+          indexOfGroup[x] = int(g.size()) - 1;
           p.insert(p.end(), pin.begin(), pin.end());
           trial.insert(trial.end(), pin.begin(), pin.end());
 
@@ -12,6 +12,12 @@
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdint>
+#include <typeinfo>
+#include <unistd.h>
 
 #include <faunus/potentials.h>
 
@@ -83,6 +89,7 @@ namespace Faunus
             std::vector<T> r2;  // r2 for intervals
             std::vector<T> c;   // c for coefficents
             T rmin2, rmax2;     // useful to save these with table
+            T dz = 0, invdz = 0, ulow = 0, uupp = 0; // interval width and values outside range (uniform grids only)
 
             bool empty() const
             {
@@ -113,6 +120,10 @@ namespace Faunus
             numdr = _numdr;
         }
 
+        T getRmin() const { return rmin; }
+
+        T getRmax() const { return rmax; }
+
         TabulatorBase()
         {
             utol = 0.01;
@@ -303,7 +314,7 @@ namespace Faunus
 			  dz * (3.0*d.c[pos6 + 3] +
 			      dz * (4.0*d.c[pos6 + 4] +
 				  dz * (5.0*d.c[pos6 + 5])))));
-            return fsum/1000.0; // Gives correct result, though not certain why /1000.0
+            return fsum;
         }
         
         /**
@@ -1249,6 +1260,343 @@ namespace Faunus
         }
     };
 
+    /**
+     * @brief Quintic spline on a uniform grid with constant time lookup
+     *
+     * Same piecewise quintic as `Andrea`, but knots are evenly spaced
+     * in the tabulated variable (r2) so that the interval is found by one
+     * multiplication and truncation instead of a binary search. The number
+     * of intervals is doubled until `utol` (and `ftol`, if set) is met at
+     * eleven check points per interval, or `mngrid` is exceeded.
+     *
+     * Values outside the tabulated range are clamped to the end values;
+     * `generate_full()` instead returns zero above `rmax` and a large
+     * repulsion below `rmin`, as `Andrea::generate_full()`.
+     *
+     * @note Steep functions need many intervals close to `rmin` and the
+     *       whole range gets this resolution. `umaxtol` and `fmaxtol` are
+     *       ignored.
+     */
+    template<typename T=double>
+    class Uniform : public TabulatorBase<T>
+    {
+    private:
+        typedef TabulatorBase<T> base; // for convenience
+
+        /** @brief Quintic coefficients for [zlow,zupp] from f, f', f'' at both ends */
+        void coefficients( std::function<T( T )> &f, T zlow, T zupp, T *c ) const
+        {
+            T u0low = f(zlow), u1low = base::f1(f, zlow), u2low = base::f2(f, zlow);
+            T u0upp = f(zupp), u1upp = base::f1(f, zupp), u2upp = base::f2(f, zupp);
+            T dz1 = zupp - zlow;
+            T dz2 = dz1 * dz1;
+            T dz3 = dz2 * dz1;
+            T a = 6 * (u0upp - u0low - u1low * dz1 - 0.5 * u2low * dz2) / dz3;
+            T b = 2 * (u1upp - u1low - u2low * dz1) / dz2;
+            T cc = (u2upp - u2low) / dz1;
+            c[0] = u0low;
+            c[1] = u1low;
+            c[2] = u2low * 0.5;
+            c[3] = (10 * a - 12 * b + 3 * cc) / 6;
+            c[4] = (-15 * a + 21 * b - 6 * cc) / (6 * dz1);
+            c[5] = (2 * a - 3 * b + cc) / (2 * dz2);
+        }
+
+        /** @brief Tabulate using `n` intervals; returns false if tolerances are not met */
+        bool tabulate( std::function<T( T )> &f, int n, typename base::data &d ) const
+        {
+            d.dz = (d.rmax2 - d.rmin2) / n;
+            d.invdz = 1 / d.dz;
+            d.r2.resize(n + 1);
+            d.c.resize(6 * n);
+            for ( int i = 0; i <= n; i++ )
+                d.r2[i] = d.rmin2 + i * d.dz;
+            d.r2[n] = d.rmax2;
+
+            const int ncheck = 11;
+            for ( int i = 0; i < n; i++ )
+            {
+                T *c = &d.c[6 * i];
+                coefficients(f, d.r2[i], d.r2[i + 1], c);
+                for ( int k = 0; k < ncheck; k++ )
+                {
+                    T dz = d.dz * k / (ncheck - 1);
+                    T z = d.r2[i] + dz;
+                    T usum = c[0] + dz * (c[1] + dz * (c[2] + dz * (c[3] + dz * (c[4] + dz * c[5]))));
+                    if ( std::abs(usum - f(z)) > base::utol )
+                        return false;
+                    if ( base::ftol != -1 )
+                    {
+                        T fsum = c[1] + dz * (2 * c[2] + dz * (3 * c[3] + dz * (4 * c[4] + dz * 5 * c[5])));
+                        if ( std::abs(fsum - base::f1(f, z)) > base::ftol )
+                            return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /** @brief Interval of `r2`, clamped to the table */
+        inline size_t interval( const typename base::data &d, T r2 ) const
+        {
+            size_t i = size_t((r2 - d.rmin2) * d.invdz);
+            size_t n = d.r2.size() - 2;
+            return (i < n) ? i : n;
+        }
+
+    public:
+        int mngrid; // Max number of intervals
+
+        Uniform() : base()
+        {
+            mngrid = 1 << 16;
+        }
+
+        /**
+         * @brief Get tabulated value at f(x)
+         * @param d Table data
+         * @param r2 x value
+         */
+        T eval( const typename base::data &d, T r2 ) const
+        {
+            if ( r2 < d.rmin2 )
+                return d.ulow;
+            if ( r2 >= d.rmax2 )
+                return d.uupp;
+            size_t i = interval(d, r2);
+            T dz = r2 - d.r2[i];
+            const T *c = &d.c[6 * i];
+            return c[0] + dz * (c[1] + dz * (c[2] + dz * (c[3] + dz * (c[4] + dz * c[5]))));
+        }
+
+        /**
+         * @brief Get tabulated value at df(x)/dx
+         * @param d Table data
+         * @param r2 x value
+         */
+        T evalDer( const typename base::data &d, T r2 ) const
+        {
+            if ( r2 < d.rmin2 || r2 >= d.rmax2 )
+                return 0;
+            size_t i = interval(d, r2);
+            T dz = r2 - d.r2[i];
+            const T *c = &d.c[6 * i];
+            return c[1] + dz * (2 * c[2] + dz * (3 * c[3] + dz * (4 * c[4] + dz * 5 * c[5])));
+        }
+
+        /**
+         * @brief Tabulate f(x)
+         */
+        typename base::data generate( std::function<T( T )> f )
+        {
+            base::check();
+            typename base::data d;
+            d.rmin2 = base::rmin * base::rmin;
+            d.rmax2 = base::rmax * base::rmax;
+            int n = 16;
+            while ( !tabulate(f, n, d))
+            {
+                n *= 2;
+                if ( n > mngrid )
+                    throw std::runtime_error("Uniform spline: try to increase utol/ftol or mngrid");
+            }
+            d.ulow = f(d.rmin2);
+            d.uupp = f(d.rmax2);
+            return d;
+        }
+
+        /**
+         * @brief Tabulate f(x); zero above and repulsive below the range
+         */
+        typename base::data generate_full( std::function<T( T )> f )
+        {
+            typename base::data d = generate(f);
+            d.ulow = 100000;
+            d.uupp = 0;
+            return d;
+        }
+
+        std::string print( typename base::data &d )
+        {
+            std::ostringstream o;
+            o << "Size of r2: " << d.r2.size() << endl
+              << "rmax2 r2=" << d.rmax2 << " r=" << sqrt(d.rmax2) << endl
+              << "rmin2 r2=" << d.rmin2 << " r=" << sqrt(d.rmin2) << endl
+              << "dr2=" << d.dz << endl;
+            return o.str();
+        }
+    };
+
+
+    /**
+     * @brief Persistent on-disk cache of generated tables
+     *
+     * Generating a table can take considerably longer than the simulation
+     * setup itself. This stores each generated table in a binary file,
+     * `<prefix><hash>.tab`, and loads it on subsequent runs instead of
+     * generating. The hash is formed from the tabulator type, its range
+     * and tolerances, a description, `descr`, and the function sampled at
+     * a number of points spaced logarithmically in the tabulated range.
+     * Samples cannot resolve features narrower than their spacing, so
+     * `descr` should hold all parameters of the tabulated function, e.g.
+     * the json input of the pair potential and the atom properties. The
+     * full key is stored in the file and compared on load to guard against
+     * hash collisions and stale files. An empty prefix disables the cache.
+     *
+     * Example:
+     *
+     *     Tabulate::Andrea<double> tab;
+     *     Tabulate::TableCache<double> cache("tables/");
+     *     auto table = cache.generate(tab, f, j.dump()); // generated once, then loaded
+     */
+    template<typename T=double>
+    class TableCache
+    {
+    private:
+        std::string prefix;
+        static const int nsample = 32; // function samples in key
+
+        /** @brief Key identifying table generated by `tab` of `f` */
+        template<class Ttabulator>
+        std::string key( Ttabulator &tab, std::function<T( T )> &f, bool full, const std::string &descr ) const
+        {
+            std::ostringstream o;
+            o << std::setprecision(17) << typeid(Ttabulator).name() << " " << sizeof(T)
+              << " full=" << full << " " << descr << "\n" << tab.info();
+            T r1 = tab.getRmax();
+            T r0 = tab.getRmin() > 0 ? tab.getRmin() : 1e-6 * r1;
+            for ( int k = 0; k < nsample; k++ )
+            {
+                T r = r0 * std::pow(r1 / r0, (k + 0.618034) / nsample);
+                o << f(r * r) << " ";
+            }
+            return o.str();
+        }
+
+        std::string filename( const std::string &key ) const
+        {
+            std::ostringstream o;
+            o << prefix << std::hex << std::setw(16) << std::setfill('0')
+              << std::hash<std::string>()(key) << ".tab";
+            return o.str();
+        }
+
+        template<class Tvec>
+        static void write( std::ostream &o, const Tvec &v )
+        {
+            std::uint64_t n = v.size();
+            o.write((const char *) &n, sizeof(n));
+            o.write((const char *) v.data(), n * sizeof(typename Tvec::value_type));
+        }
+
+        template<class Tvec>
+        static bool read( std::istream &in, Tvec &v )
+        {
+            std::uint64_t n = 0;
+            in.read((char *) &n, sizeof(n));
+            if ( !in || n > (std::uint64_t(1) << 32))
+                return false;
+            v.resize(n);
+            if ( n > 0 )
+                in.read((char *) &v[0], n * sizeof(typename Tvec::value_type));
+            return bool(in);
+        }
+
+        template<class Tdata>
+        bool load( const std::string &file, const std::string &key, Tdata &d ) const
+        {
+            std::ifstream in(file.c_str(), std::ios::binary);
+            if ( !in )
+                return false;
+            std::string k;
+            if ( !read(in, k) || k != key )
+                return false;
+            if ( !read(in, d.r2) || !read(in, d.c))
+                return false;
+            T x[6];
+            in.read((char *) x, sizeof(x));
+            if ( !in )
+                return false;
+            d.rmin2 = x[0];
+            d.rmax2 = x[1];
+            d.dz = x[2];
+            d.invdz = x[3];
+            d.ulow = x[4];
+            d.uupp = x[5];
+            return true;
+        }
+
+        /* written to a temporary file, unique to the process, and renamed so that concurrent runs never see partial tables */
+        template<class Tdata>
+        void save( const std::string &file, const std::string &key, const Tdata &d ) const
+        {
+            std::string tmp = file + "." + std::to_string(getpid()) + ".tmp";
+            std::ofstream o(tmp.c_str(), std::ios::binary);
+            if ( !o )
+                return;
+            write(o, key);
+            write(o, d.r2);
+            write(o, d.c);
+            T x[6] = {d.rmin2, d.rmax2, d.dz, d.invdz, d.ulow, d.uupp};
+            o.write((const char *) x, sizeof(x));
+            o.close();
+            if ( !o || std::rename(tmp.c_str(), file.c_str()) != 0 )
+                std::remove(tmp.c_str());
+        }
+
+        template<class Ttabulator>
+        typename Ttabulator::data cached( Ttabulator &tab, std::function<T( T )> &f, bool full,
+                                          const std::string &descr )
+        {
+            typename Ttabulator::data d;
+            std::string k = key(tab, f, full, descr), file = filename(k);
+            if ( load(file, k, d))
+            {
+                hits++;
+                return d;
+            }
+            d = full ? tab.generate_full(f) : tab.generate(f);
+            save(file, k, d);
+            misses++;
+            return d;
+        }
+
+    public:
+        int hits = 0, misses = 0; //!< Number of tables loaded and generated
+
+        TableCache( const std::string &prefix = "" ) : prefix(prefix) {}
+
+        bool enabled() const { return !prefix.empty(); }
+
+        /** @brief Name of file holding the table of `f` generated by `tab` */
+        template<class Ttabulator>
+        std::string file( Ttabulator &tab, std::function<T( T )> f, bool full = false,
+                          const std::string &descr = "" ) const
+        {
+            return filename(key(tab, f, full, descr));
+        }
+
+        /** @brief As `tab.generate(f)` but load table from disk if available */
+        template<class Ttabulator>
+        typename Ttabulator::data generate( Ttabulator &tab, std::function<T( T )> f,
+                                            const std::string &descr = "" )
+        {
+            if ( !enabled())
+                return tab.generate(f);
+            return cached(tab, f, false, descr);
+        }
+
+        /** @brief As `tab.generate_full(f)` but load table from disk if available */
+        template<class Ttabulator>
+        typename Ttabulator::data generate_full( Ttabulator &tab, std::function<T( T )> f,
+                                                 const std::string &descr = "" )
+        {
+            if ( !enabled())
+                return tab.generate_full(f);
+            return cached(tab, f, true, descr);
+        }
+    };
+
   } //Tabulate namespace
 
 #ifdef FAUNUS_POTENTIAL_H
@@ -1256,8 +1604,35 @@ namespace Faunus
   namespace Potential
   {
 
+    /**
+     * @brief Atom properties entering pair potentials, for `Tabulate::TableCache` keys
+     */
+    inline std::string tableKey( const AtomData &a, const AtomData &b )
+    {
+        std::ostringstream o;
+        o << std::setprecision(17);
+        for ( auto d : {&a, &b} )
+            o << " " << d->name << " " << d->charge << " " << d->radius << " " << d->sigma << " "
+              << d->eps << " " << d->mw << " " << d->muscalar << " " << d->alphax << " " << d->tfe
+              << " " << d->hydrophobic;
+        return o.str();
+    }
+
     /**
      * @brief Tabulated potential between all particle types
+     *
+     * Tables are generated the first time a pair of particle types is
+     * encountered, or for all pairs of atom types in the constructor if
+     * `tab_prebuild` is true. Generated tables may be stored on disk and
+     * reused in later runs, see `Tabulate::TableCache`.
+     *
+     * Keyword        | Description
+     * -------------- | -------------------------------------------------
+     * `tab_rmin`     | Minimum distance of table (default: 1)
+     * `tab_rmax`     | Maximum distance of table (default: 100)
+     * `tab_utol`     | Energy tolerance (default: 0.01)
+     * `tab_cache`    | File prefix for cached tables, e.g. `"tables/"` (default: none)
+     * `tab_prebuild` | Tabulate all atom type pairs on construction (default: false)
      */
     template<typename Tpairpot, typename Ttabulator=Tabulate::Andrea<double> >
     class PotentialTabulate : public Tpairpot
@@ -1266,9 +1641,19 @@ namespace Faunus
         Ttabulator tab;
         typedef opair<int> Tpair;
         std::map<Tpair, typename Ttabulator::data> m;
+        Tabulate::TableCache<double> cache;
+        std::string descr; // parameters of Tpairpot for table cache
+
+        template<class Tparticle>
+        void generate( const Tparticle &a, const Tparticle &b )
+        {
+            std::function<double( double )> f = [=]( double r2 ) { return Tpairpot(*this)(a, b, r2); };
+            m[Tpair(a.id, b.id)] = cache.generate_full(tab, f, descr + tableKey(atom[a.id], atom[b.id]));
+        }
 
     public:
-        PotentialTabulate( Tmjson &j ) : Tpairpot(j)
+        PotentialTabulate( Tmjson &j ) : Tpairpot(j), cache(j.value("tab_cache", std::string())),
+                                         descr(Tpairpot::name + " " + j.dump())
         {
             tab.setRange(
                 j["tab_rmin"] | 1.0,
@@ -1278,17 +1663,25 @@ namespace Faunus
                 j["tab_ftol"] | -1.0,
                 j["tab_umaxtol"] | -1.0,
                 j["tab_fmaxtol"] | -1.0);
+            if ( j.value("tab_prebuild", false))
+                for ( auto &i : atom )
+                    for ( auto &k : atom )
+                        if ( i.id > 0 && k.id >= i.id )
+                        {
+                            PointParticle a, b;
+                            a = i;
+                            b = k;
+                            generate(a, b);
+                        }
         }
 
         template<class Tparticle>
         double operator()( const Tparticle &a, const Tparticle &b, double r2 )
         {
-            Tpair ab(a.id, b.id);
-            auto it = m.find(ab);
+            auto it = m.find(Tpair(a.id, b.id));
             if ( it != m.end())
                 return tab.eval(it->second, r2);
-            std::function<double( double )> f = [=]( double r2 ) { return Tpairpot(*this)(a, b, r2); };
-            m[ab] = tab.generate_full(f);
+            generate(a, b);
             return (*this)(a, b, r2);
         }
     };
@@ -1373,7 +1766,7 @@ namespace Faunus
      *
      * ~~~{.js}
      * "pairpotentialmap" : {
-     *     "spline"  : { "rmin":1e-6, "rmax":100, "utol":0.01 },
+     *     "spline"  : { "rmin":1e-6, "rmax":100, "utol":0.01, "cache":"tables/" },
      *     "default" : {
      *         "coulomb" : { "epsr":2.0 },
      *         "lennardjones" : {}
@@ -1382,7 +1775,9 @@ namespace Faunus
      * }
      * ~~~
      *
-     * All pair-potentials are tabulated in constructor
+     * All pair-potentials are tabulated in constructor. If `cache` is
+     * given as a file prefix, tables are stored on disk and reused by
+     * later runs with the same settings, see `Tabulate::TableCache`.
      */
     template<typename Ttabulator=Tabulate::Andrea<double>, typename Tparticle=PointParticle>
     class PotentialMapSpline : public PairPotentialBase
@@ -1393,6 +1788,7 @@ namespace Faunus
         typedef typename Ttabulator::data Tdata;
         PairMatrix <Tdata> m;
         Ttabulator tab;
+        Tabulate::TableCache<double> cache;
         bool verbose;
         double rmin, rmax;
 
@@ -1416,6 +1812,7 @@ namespace Faunus
                 j["fmaxtol"] | -1);
 
             verbose = in.value("verbose", false);
+            cache = Tabulate::TableCache<double>(j.value("cache", std::string()));
 
             m.resize(atom.size());
 
@@ -1429,7 +1826,8 @@ namespace Faunus
                         atom[v.at(0)].id,
                         atom[v.at(1)].id);
                     auto d = mixPairPotential(i.value(), p.first, p.second);
-                    m.set(p.first, p.second, tab.generate(d.first));
+                    m.set(p.first, p.second,
+                          cache.generate(tab, d.first, i.value().dump() + tableKey(atom[p.first], atom[p.second])));
                     nfo[d.second].insert(p);
                 }
             }
@@ -1441,7 +1839,7 @@ namespace Faunus
                         if ( m(i.id, j.id).empty())
                         {
                             auto d = mixPairPotential(in["default"], i.id, j.id);
-                            m.set(i.id, j.id, tab.generate(d.first));
+                            m.set(i.id, j.id, cache.generate(tab, d.first, in["default"].dump() + tableKey(i, j)));
                             nfo[d.second].insert(Tpair(i.id, j.id));
                         }
 
@@ -1499,76 +1897,51 @@ namespace Faunus
      * If the pair is not recognized, i.e. not added with the
      * `add()` function, the `Tdefault` pair potential is used.
      * If the pair is found then a tabulation will be used.
+     * Tables are stored on disk and reused if the `tab_cache` file
+     * prefix is given, see `Tabulate::TableCache`.
      */
     template<typename Tdefault, typename Ttabulator=Tabulate::Andrea<double>, typename Tparticle=PointParticle>
-    class PotentialMapTabulated : public PotentialMap<Tdefault>
+    class PotentialMapTabulated : public PotentialMap<Tdefault, Tparticle, double, Ttabulator>
     {
     private:
-        typedef opair<int> Tpair;
-        typedef PotentialMap <Tdefault> base;
-        double rmin2, rmax2;
+        typedef PotentialMap<Tdefault, Tparticle, double, Ttabulator> base;
+        Tabulate::TableCache<double> cache;
         int print;
-        Ttabulator tab;
-        std::map<Tpair, typename Ttabulator::data> mtab;
 
     public:
         PotentialMapTabulated( InputMap &in ) : base(in)
         {
-            rmin2 = in.get<double>("tab_rmin", 1.0);
-            rmax2 = in.get<double>("tab_rmax", 100.0);
-            rmin2 = rmin2 * rmin2;
-            rmax2 = rmax2 * rmax2;
-            tab.setRange(
+            base::tab.setRange(
                 in.get<double>("tab_rmin", 1.0),
                 in.get<double>("tab_rmax", 100.0));
-            tab.setTolerance(
+            base::tab.setTolerance(
                 in.get<double>("tab_utol", 0.01),
                 in.get<double>("tab_ftol", -1),
                 in.get<double>("tab_umaxtol", -1),
                 in.get<double>("tab_fmaxtol", -1));
             print = in.get<int>("tab_print", 0);
-        }
-
-        double operator()( const Tparticle &a, const Tparticle &b, double r2 )
-        {
-            auto ab = Tpair(a.id, b.id);
-            auto it = mtab.find(ab);
-            if ( it != mtab.end())
-            {
-                if ( r2 < it->second.rmax2 )
-                    if ( r2 > it->second.rmin2 )
-                        return tab.eval(it->second, r2);
-                return base::m[ab](a, b, r2); // fall back to original
-            }
-            return Tdefault::operator()(a, b, r2); // fall back to default
+            cache = Tabulate::TableCache<double>(in.get<std::string>("tab_cache", ""));
         }
 
         template<class Tpairpot>
         void add( AtomData::Tid id1, AtomData::Tid id2, Tpairpot pot )
         {
-            Tparticle a, b;
-            a = atom[id1];
-            b = atom[id2];
-            base::add(a.id, b.id, pot);
-            std::function<double( double )> f = [=]( double r2 ) { return Tpairpot(pot)(a, b, r2); };
-            mtab[Tpair(id1, id2)] = tab.generate(f);
+            base::add(id1, id2, pot);
+            base::spline(id1, id2, cache.generate(base::tab, base::pairFunction(id1, id2),
+                                                  pot.name + " " + pot.info(0) + tableKey(atom[id1], atom[id2])));
         }
 
         std::string info( char w = 20 )
         {
             using namespace Faunus::textio;
             std::ostringstream o(base::info(w));
-            o << tab.info(w) << std::endl;
-            for ( auto &i : mtab )
-            {
-                auto ab = Tpair(i.first.first, i.first.second);
-                auto it = mtab.find(ab);
+            o << base::tab.info(w) << std::endl;
+            for ( auto &k : base::kernels )
                 o << pad(SUB,
                          w,
-                         "Nbr of elements in table (" + atom[i.first.first].name + "<->" + atom[i.first.second].name
+                         "Nbr of elements in table (" + atom[k.id1].name + "<->" + atom[k.id2].name
                              + "): ")
-                  << it->second.r2.size() << endl;
-            }
+                  << k.table.r2.size() << endl;
             o << endl;
             if ( print == 1 )
                 print_tabulation();
@@ -1577,31 +1950,28 @@ namespace Faunus
 
         void print_tabulation( int n = 1000 )
         {
-            for ( auto &i : mtab )
+            for ( auto &k : base::kernels )
             {
-                auto ab = Tpair(i.first.first, i.first.second);
-                auto it = mtab.find(ab);
-
                 Tparticle a, b;
-                a = atom[i.first.first];
-                b = atom[i.first.second];
+                a = atom[k.id1];
+                b = atom[k.id2];
 
                 std::ofstream
-                    ff1(std::string(atom[i.first.first].name + "." + atom[i.first.second].name + ".real.dat").c_str());
+                    ff1(std::string(atom[k.id1].name + "." + atom[k.id2].name + ".real.dat").c_str());
                 ff1.precision(10);
 
                 std::ofstream
-                    ff2(std::string(atom[i.first.first].name + "." + atom[i.first.second].name + ".tab.dat").c_str());
+                    ff2(std::string(atom[k.id1].name + "." + atom[k.id2].name + ".tab.dat").c_str());
                 ff2.precision(10);
 
-                double max = it->second.r2.at(it->second.r2.size() - 2);
-                double min = it->second.rmin2;
+                double max = k.table.r2.at(k.table.r2.size() - 2);
+                double min = k.table.rmin2;
                 double dr = (max - min) / (double) n;
                 for ( int j = 1; j < n; j++ )
                 {
                     double r2 = min + dr * ((double) j);
-                    ff1 << sqrt(r2) << " " << base::m[ab](a, b, r2) << endl;
-                    ff2 << sqrt(r2) << " " << tab.eval(it->second, r2) << endl;
+                    ff1 << sqrt(r2) << " " << k.f(a, b, r2) << endl;
+                    ff2 << sqrt(r2) << " " << base::tab.eval(k.table, r2) << endl;
                 }
             }
         }
@@ -3,7 +3,7 @@ unset(CMAKE_CXX_FLAGS)
 
 # GNU
 if (CMAKE_CXX_COMPILER_ID MATCHES "GNU")
-  set(CMAKE_CXX_FLAGS "-funroll-loops -Wall -Wno-unknown-pragmas -Wextra -Wno-unused-parameter -Wno-reorder -Wno-misleading-indentation")
+  set(CMAKE_CXX_FLAGS "-funroll-loops -fno-math-errno -Wall -Wno-unknown-pragmas -Wextra -Wno-unused-parameter -Wno-reorder -Wno-misleading-indentation")
 
 # Intel
 elseif (CMAKE_CXX_COMPILER_ID MATCHES "Intel")
@@ -11,7 +11,7 @@ elseif (CMAKE_CXX_COMPILER_ID MATCHES "Intel")
 
 # Clang
 elseif (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
-  set(CMAKE_CXX_FLAGS "-Wextra -pedantic -Wno-unused-parameter -Wno-unknown-pragmas")
+  set(CMAKE_CXX_FLAGS "-fno-math-errno -Wextra -pedantic -Wno-unused-parameter -Wno-unknown-pragmas")
   if(APPLE)
     set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -stdlib=libc++")
   endif()
@@ -0,0 +1,425 @@
+#include <faunus/faunus.h>
+#include <faunus/ewald.h>
+
+/*
+ * Micro benchmarks of performance critical parts of Faunus.
+ * Not built by default; to compile and run:
+ *
+ *     $ make example_benchmark
+ *     $ cd src/examples/
+ *     $ ./benchmark
+ */
+
+using namespace Faunus;
+
+/**
+ * @brief Wall time (microseconds) per call of `f`, averaged over `n` calls
+ *
+ * `f` is called through `std::function` to keep the compiler from
+ * hoisting the timed work out of the loop.
+ */
+double timeit( std::function<void()> f, int n )
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for ( int i = 0; i < n; i++ )
+        f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / double(n);
+}
+
+/**
+ * @brief Isotropic particle with the former memory layout of `PointParticle`
+ *
+ * Before anisotropic accessors became static traits, `PointParticle`
+ * stored dummy tensor, point, and scalar members for these.
+ */
+struct LegacyParticle : public PointParticle
+{
+    Tensor<double> zeroT;
+    Point zeroP;
+    double zeroD;
+    bool trueD;
+
+    LegacyParticle() : zeroP(0, 0, 0), zeroD(0), trueD(true) {}
+
+    template<typename OtherDerived>
+    LegacyParticle( const Eigen::MatrixBase<OtherDerived> &other ) : PointParticle(other) {}
+
+    template<typename OtherDerived>
+    LegacyParticle &operator=( const Eigen::MatrixBase<OtherDerived> &other )
+    {
+        PointParticle::operator=(other);
+        return *this;
+    }
+};
+
+/** @brief Time `Nonbonded::g2g` between two groups of `n` particles each */
+template<class Tparticle>
+void particleLayout( Tmjson &j, int n, int repeat )
+{
+    typedef Space<Geometry::Cuboid, Tparticle> Tspace;
+    Energy::Nonbonded<Tspace, Potential::Coulomb> pot(j);
+    pot.geo.setlen(Point(100, 100, 100));
+
+    typename Tspace::ParticleVector p(2 * n);
+    for ( size_t i = 0; i < p.size(); i++ )
+    {
+        pot.geo.randompos(p[i]);
+        p[i].charge = (i % 2 == 0) ? 1 : -1;
+    }
+    Group g1(0, n - 1), g2(n, 2 * n - 1);
+
+    double u = 0;
+    double t = timeit([&]() { u = pot.g2g(p, g1, g2); }, repeat);
+    cout << "  sizeof = " << std::setw(4) << sizeof(Tparticle) << " bytes"
+         << "  vector = " << std::setw(6) << std::setprecision(3) << p.size() * sizeof(Tparticle) / 1e6 << " MB"
+         << "  g2g = " << std::setw(8) << std::setprecision(4) << 1e3 * t / (double(n) * n) << " ns/pair"
+         << "  (u = " << u << " kT)" << endl;
+}
+
+/** @brief Coulomb potential hidden from `Potential::is_batched` */
+struct UnbatchedCoulomb : public Potential::Coulomb
+{
+    UnbatchedCoulomb( Tmjson &j ) : Potential::Coulomb(j) {}
+};
+
+/**
+ * @brief Time `Nonbonded::g2g` between two groups of `n` particles using `Tpairpot`
+ * @param arrays Keep structure-of-arrays mirrors of the particle vectors
+ */
+template<class Tpairpot>
+void pairKernel( Tmjson &j, int n, int repeat, bool arrays = false )
+{
+    typedef Space<Geometry::Cuboid, PointParticle> Tspace;
+    Tspace spc(j);
+    Energy::Nonbonded<Tspace, Tpairpot> pot(j);
+
+    spc.p.resize(2 * n);
+    for ( size_t i = 0; i < spc.p.size(); i++ )
+    {
+        spc.geo.randompos(spc.p[i]);
+        spc.p[i].charge = (i % 2 == 0) ? 1 : -1;
+    }
+    spc.trial = spc.p;
+    spc.enableArrays(arrays);
+    pot.setSpace(spc);
+    Group g1(0, n - 1), g2(n, 2 * n - 1);
+
+    double u = 0;
+    double t = timeit([&]() { u = pot.g2g(spc.p, g1, g2); }, repeat);
+    cout << "  g2g = " << std::setw(8) << std::setprecision(4) << 1e3 * t / (double(n) * n) << " ns/pair"
+         << "  (u = " << u << " kT)" << endl;
+}
+
+/**
+ * @brief Time `Nonbonded::g2g` for two atom types with a `PotentialMap` or a `CombinedPairPotential`
+ *
+ * A-A and A-B pairs are assigned Coulomb plus Lennard-Jones while B-B use the default, Coulomb.
+ */
+template<class Tpairpot>
+void pairMap( Tmjson &j, int n, int repeat, std::function<void( Tpairpot & )> setup )
+{
+    typedef Space<Geometry::Cuboid, PointParticle> Tspace;
+    Tspace spc(j);
+    Energy::Nonbonded<Tspace, Tpairpot> pot(j);
+    setup(pot.pairpot);
+
+    spc.p.resize(2 * n);
+    for ( size_t i = 0; i < spc.p.size(); i++ )
+    {
+        spc.geo.randompos(spc.p[i]);
+        spc.p[i].id = atom[(i % 3 == 0) ? "B" : "A"].id;
+        spc.p[i].charge = (i % 2 == 0) ? 1 : -1;
+        spc.p[i].radius = 1;
+    }
+    spc.trial = spc.p;
+    pot.setSpace(spc);
+    Group g1(0, n - 1), g2(n, 2 * n - 1);
+
+    double u = 0;
+    double t = timeit([&]() { u = pot.g2g(spc.p, g1, g2); }, repeat);
+    cout << "  g2g = " << std::setw(8) << std::setprecision(4) << 1e3 * t / (double(n) * n) << " ns/pair"
+         << "  (u = " << u << " kT)" << endl;
+}
+
+/** @brief Time `Ttabulator::eval` for `n` random points in [rmin^2,rmax^2] */
+template<class Ttabulator>
+void tabulator( std::function<double( double )> f, double rmin, double rmax, double utol, int n )
+{
+    Ttabulator tab;
+    tab.setRange(rmin, rmax);
+    tab.setTolerance(utol);
+    auto d = tab.generate(f);
+
+    std::vector<double> x(n);
+    for ( auto &r2 : x )
+        r2 = rmin * rmin + slump() * (rmax * rmax - rmin * rmin);
+    double u = 0, error = 0;
+    for ( auto r2 : x )
+        error = std::max(error, std::fabs(tab.eval(d, r2) - f(r2)));
+    double t = timeit([&]() {
+        for ( auto r2 : x )
+            u += tab.eval(d, r2);
+    }, 10);
+    cout << "  knots = " << std::setw(6) << d.r2.size()
+         << "  max error = " << std::setw(8) << std::setprecision(2) << error
+         << "  eval = " << std::setw(8) << std::setprecision(4) << 1e3 * t / n << " ns" << endl;
+}
+
+/** @brief Harmonic restraint along z */
+struct HarmonicZ : public Potential::ExternalPotentialBase<>
+{
+    HarmonicZ( Tmjson & ) { name = "Harmonic z"; }
+
+    string _info() override { return name; }
+
+    template<class Tparticle>
+    double operator()( const Tparticle &a ) const { return 0.5 * a.z() * a.z(); }
+};
+
+/** @brief Sum of energy terms through virtual calls, as in `Energy::Hamiltonian` */
+template<class Tspace>
+struct VirtualHamiltonian : public Energy::Energybase<Tspace>
+{
+    typedef Energy::Energybase<Tspace> Tbase;
+    std::vector<Tbase *> baselist;
+
+    string _info() override { return string(); }
+
+    double i2all( typename Tbase::Tpvec &p, int i ) override
+    {
+        double u = 0;
+        for ( auto b : baselist )
+            u += b->i2all(p, i);
+        return u;
+    }
+
+    double i_external( const typename Tbase::Tpvec &p, int i ) override
+    {
+        double u = 0;
+        for ( auto b : baselist )
+            u += b->i_external(p, i);
+        return u;
+    }
+
+    double i_internal( const typename Tbase::Tpvec &p, int i ) override
+    {
+        double u = 0;
+        for ( auto b : baselist )
+            u += b->i_internal(p, i);
+        return u;
+    }
+
+    double g_external( const typename Tbase::Tpvec &p, Group &g ) override
+    {
+        double u = 0;
+        for ( auto b : baselist )
+            u += b->g_external(p, g);
+        return u;
+    }
+
+    double g_internal( const typename Tbase::Tpvec &p, Group &g ) override
+    {
+        double u = 0;
+        for ( auto b : baselist )
+            u += b->g_internal(p, g);
+        return u;
+    }
+
+    double g2g( const typename Tbase::Tpvec &p, Group &g1, Group &g2 ) override
+    {
+        double u = 0;
+        for ( auto b : baselist )
+            u += b->g2g(p, g1, g2);
+        return u;
+    }
+};
+
+/** @brief Time single particle, group and system energies through `Energybase` */
+template<class Tspace>
+void hamiltonian( Energy::Energybase<Tspace> &pot, typename Tspace::ParticleVector &p, int repeat )
+{
+    Group g(0, p.size() - 1);
+    double u = 0, v = 0, w = 0;
+    double t1 = timeit([&]() {
+        u = 0;
+        for ( size_t i = 0; i < p.size(); i++ )
+            u += pot.i_total(p, i);
+    }, repeat);
+    double t2 = timeit([&]() { v = pot.g_external(p, g); }, 100 * repeat);
+    double t3 = timeit([&]() { w = pot.systemEnergy(p); }, 2 * repeat);
+    cout << "  i_total = " << std::setw(8) << std::setprecision(4) << 1e3 * t1 / p.size() << " ns/particle"
+         << "  g_external = " << std::setw(8) << std::setprecision(4) << 1e3 * t2 / p.size() << " ns/particle"
+         << "  systemEnergy = " << std::setw(8) << std::setprecision(4) << 1e3 * t3 / p.size() << " ns/particle"
+         << "  (u = " << u << ", " << v << ", " << w << " kT)" << endl;
+}
+
+/** @brief Time full and single particle updates of the Ewald structure factors */
+void ewald( Tmjson &j, int n )
+{
+    typedef Space<Geometry::Cuboid, PointParticle> Tspace;
+    Tmjson _j = j;
+    _j["energy"]["nonbonded"]["ewald"] = {
+        {"alpha", 0.2}, {"cutoff", 14.0}, {"cutoffK", 8.0}, {"eps_surf", 0.0}, {"spherical_sum", true}};
+    Tspace spc(_j);
+    spc.p.resize(n);
+    for ( size_t i = 0; i < spc.p.size(); i++ )
+    {
+        spc.geo.randompos(spc.p[i]);
+        spc.p[i].charge = (i % 2 == 0) ? 1 : -1;
+    }
+    spc.trial = spc.p;
+    Energy::NonbondedEwald<Tspace, Potential::HardSphere> pot(_j);
+    pot.setSpace(spc);
+
+    Tspace::Change c;
+    c.mvGroup[0].push_back(0);
+    spc.trial[0] = Point(1, 2, 3);
+    double t1 = timeit([&]() { pot.setSpace(spc); }, 5);
+    double t2 = timeit([&]() { pot.updateChange(c); }, 200);
+    cout << "  full update = " << std::setw(8) << std::setprecision(4) << 1e-3 * t1 << " ms"
+         << "  single particle = " << std::setw(8) << std::setprecision(4) << t2 << " us"
+         << "  (u = " << pot.external(spc.trial) << " kT)" << endl;
+}
+
+int main()
+{
+    Tmjson j = {
+        {"atomlist", {{"A", {{"q", 1.0}, {"r", 1.0}}}, {"B", {{"q", -1.0}, {"r", 1.0}}}}},
+        {"energy", {{"nonbonded", {{"epsr", 80.0}}}}},
+        {"moleculelist", {{"ions", {{"atoms", "A"}, {"atomic", true}}}}},
+        {"system", {{"geometry", {{"length", 100.0}}}}}
+    };
+    atom.include(j);
+    slump.seed(1);
+
+    for ( int n : {1000, 10000, 25000} )
+    {
+        int repeat = std::max(1, int(5e7 / (double(n) * n)));
+        cout << "Particle layout, Nonbonded::g2g, 2x" << n << " particles:" << endl;
+        slump.seed(1);
+        cout << " LegacyParticle";
+        particleLayout<LegacyParticle>(j, n, repeat);
+        slump.seed(1);
+        cout << " PointParticle ";
+        particleLayout<PointParticle>(j, n, repeat);
+    }
+
+    for ( int n : {1000, 10000} )
+    {
+        int repeat = std::max(1, int(5e7 / (double(n) * n)));
+        cout << "Pair kernels, Nonbonded::g2g, 2x" << n << " particles:" << endl;
+        slump.seed(1);
+        cout << " Coulomb pair-by-pair";
+        pairKernel<UnbatchedCoulomb>(j, n, repeat);
+        slump.seed(1);
+        cout << " Coulomb batched     ";
+        pairKernel<Potential::Coulomb>(j, n, repeat);
+        slump.seed(1);
+        cout << " Coulomb batched+SoA ";
+        pairKernel<Potential::Coulomb>(j, n, repeat, true);
+    }
+
+    {
+        typedef Space<Geometry::Cuboid, PointParticle> Tspace;
+        typedef Energy::Nonbonded<Tspace, Potential::Coulomb> Tnonbonded;
+        typedef Energy::ExternalPotential<Tspace, HarmonicZ> Texternal;
+        Tspace spc(j);
+        spc.p.resize(1000);
+        for ( size_t i = 0; i < spc.p.size(); i++ )
+        {
+            spc.geo.randompos(spc.p[i]);
+            spc.p[i].charge = (i % 2 == 0) ? 1 : -1;
+        }
+        spc.trial = spc.p;
+        Group g(0, spc.p.size() - 1);
+        spc.groupList().push_back(&g);
+
+        Tnonbonded nb(j);
+        Texternal ext(j);
+        VirtualHamiltonian<Tspace> virt;
+        virt.baselist = {&nb, &ext};
+        auto &combined = nb + ext;
+        auto stat = Energy::makeHamiltonian(nb, ext);
+        std::vector<Energy::Energybase<Tspace> *> all = {&nb, &ext, &virt, &combined, &stat};
+        for ( auto pot : all )
+            pot->setSpace(spc);
+
+        cout << "Hamiltonian, Nonbonded + ExternalPotential, " << spc.p.size() << " particles:" << endl;
+        cout << " virtual list       ";
+        hamiltonian<Tspace>(virt, spc.p, 20);
+        cout << " operator+          ";
+        hamiltonian<Tspace>(combined, spc.p, 20);
+        cout << " StaticHamiltonian  ";
+        hamiltonian<Tspace>(stat, spc.p, 20);
+    }
+
+    {
+        std::function<double( double )> erfc2 = []( double q ) { return erfc(2 * q); };
+        std::function<double( double )> lj = []( double r2 ) { double s6 = 1 / (r2 * r2 * r2); return 4 * (s6 * s6 - s6); };
+        cout << "Tabulation, erfc(2x), x in [0:1], utol 1e-9:" << endl;
+        slump.seed(1);
+        cout << " Andrea ";
+        tabulator<Tabulate::Andrea<double>>(erfc2, 0, 1, 1e-9, 100000);
+        slump.seed(1);
+        cout << " Uniform";
+        tabulator<Tabulate::Uniform<double>>(erfc2, 0, 1, 1e-9, 100000);
+        cout << "Tabulation, Lennard-Jones, r in [0.9:5], utol 1e-5:" << endl;
+        slump.seed(1);
+        cout << " Andrea ";
+        tabulator<Tabulate::Andrea<double>>(lj, 0.9, 5, 1e-5, 100000);
+        slump.seed(1);
+        cout << " Uniform";
+        tabulator<Tabulate::Uniform<double>>(lj, 0.9, 5, 1e-5, 100000);
+
+        Tmjson _j = j;
+        _j["energy"]["nonbonded"]["coulombtype"] = "qpotential";
+        _j["energy"]["nonbonded"]["cutoff"] = 30.0;
+        cout << "Pair kernels, Nonbonded::g2g, 2x1000 particles:" << endl;
+        slump.seed(1);
+        cout << " CoulombGalore, Andrea  ";
+        pairKernel<Potential::CoulombGalore>(_j, 1000, 50);
+        slump.seed(1);
+        cout << " CoulombGalore, Uniform ";
+        pairKernel<Potential::CoulombGaloreTabulate<Tabulate::Uniform<double>>>(_j, 1000, 50);
+    }
+
+    {
+        typedef Potential::CombinedPairPotential<Potential::Coulomb, Potential::LennardJones> Tcoulomblj;
+        typedef Potential::PotentialMap<Potential::Coulomb> Tmap;
+        auto a = atom["A"].id, b = atom["B"].id;
+        Tmjson _j = j;
+        _j["energy"]["nonbonded"]["eps"] = 0.1;
+        cout << "Pair kernels, Nonbonded::g2g, 2x1000 particles, two atom types:" << endl;
+        slump.seed(1);
+        cout << " CombinedPairPotential    ";
+        pairMap<Tcoulomblj>(_j, 1000, 50, []( Tcoulomblj & ) {});
+        slump.seed(1);
+        cout << " PotentialMap             ";
+        pairMap<Tmap>(_j, 1000, 50, [&]( Tmap &m ) {
+            m.add(a, a, Tcoulomblj(_j["energy"]["nonbonded"]));
+            m.add(a, b, Tcoulomblj(_j["energy"]["nonbonded"]));
+        });
+        typedef Potential::PotentialMap<Potential::Coulomb, PointParticle, double, Tabulate::Andrea<double>> Tmapandrea;
+        slump.seed(1);
+        cout << " PotentialMap, Andrea     ";
+        pairMap<Tmapandrea>(_j, 1000, 50, [&]( Tmapandrea &m ) {
+            m.add(a, a, Tcoulomblj(_j["energy"]["nonbonded"]));
+            m.add(a, b, Tcoulomblj(_j["energy"]["nonbonded"]));
+            m.tabulate(a, a, 2.0, 90.0, 1e-3);
+            m.tabulate(a, b, 2.0, 90.0, 1e-3);
+        });
+        slump.seed(1);
+        cout << " PotentialMap, tabulated  ";
+        pairMap<Tmap>(_j, 1000, 50, [&]( Tmap &m ) {
+            m.add(a, a, Tcoulomblj(_j["energy"]["nonbonded"]));
+            m.add(a, b, Tcoulomblj(_j["energy"]["nonbonded"]));
+            m.tabulate(a, a, 2.0, 90.0, 1e-3);
+            m.tabulate(a, b, 2.0, 90.0, 1e-3);
+        });
+    }
+
+    cout << "Ewald structure factors, NonbondedEwald, 1000 particles:" << endl;
+    slump.seed(1);
+    ewald(j, 1000);
+}
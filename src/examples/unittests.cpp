@@ -37,6 +37,66 @@ TEST_CASE("Spline table", "Spline")
   checkTabulator(Tabulate::AndreaIntel<double>());
   checkTabulator(Tabulate::Andrea<double>());
   checkTabulator(Tabulate::Linear<double>());
+  checkTabulator(Tabulate::Uniform<double>());
+
+  // uniform grid: derivative and values outside range
+  Tabulate::Uniform<double> u;
+  u.setRange(0, 1);
+  u.setTolerance(1e-9, 1e-5);
+  std::function<double(double)> g = [](double x) { return erfc(2*x); };
+  auto d = u.generate(g);
+  for (double x=0; x<1; x+=0.013) {
+    CHECK( u.eval(d,x) == Approx(g(x)).epsilon(1e-8) );
+    CHECK( u.evalDer(d,x) == Approx(-4/sqrt(pc::pi)*exp(-4*x*x)).epsilon(1e-4) );
+  }
+  CHECK( u.eval(d,2.0) == Approx(g(1.0)) );
+  d = u.generate_full(g);
+  CHECK( u.eval(d,2.0) == 0 );
+
+  // forces from the derivative of the tabulated splitting function
+  Tmjson jg = { {"coulombtype","yukawa"}, {"cutoff",12.0}, {"epsr",80.0}, {"debyelength",10.0} };
+  Potential::CoulombGalore ga(jg);
+  Potential::CoulombGaloreTabulate<Tabulate::Uniform<double>> gu(jg);
+  PointParticle q1, q2;
+  q1.charge = 1;
+  q2.charge = -1;
+  for (double r : {2.0, 5.0, 9.0}) {
+    double h = 1e-4, du = ( ga(q1,q2,(r+h)*(r+h)) - ga(q1,q2,(r-h)*(r-h)) ) / (2*h);
+    CHECK( ga.force(q1,q2,r*r,Point(r,0,0)).x() == Approx(-du).epsilon(1e-3) );
+    CHECK( gu.force(q1,q2,r*r,Point(r,0,0)).x() == Approx( ga.force(q1,q2,r*r,Point(r,0,0)).x() ).epsilon(1e-4) );
+  }
+  jg["coulombtype"] = "plain";
+  Potential::CoulombGalore gp(jg);
+  CHECK( gp.force(q1,q2,25.0,Point(3,4,0)).y() == Approx( Potential::Coulomb(jg).force(q1,q2,25.0,Point(3,4,0)).y() ) );
+
+  // on-disk cache: generate, load, and new file for changed function
+  Tabulate::TableCache<double> cache("unittests-tab-");
+  Tabulate::Andrea<double> an;
+  an.setRange(0.9, 100);
+  an.setTolerance(0.01, 0.01);
+  std::function<double(double)> h = [](double x) { return 1/x; }, h2 = [](double x) { return 2/x; };
+  auto d1 = cache.generate_full(an, h);
+  auto d2 = cache.generate_full(an, h);
+  auto d3 = cache.generate_full(an, h2);
+  CHECK( cache.misses == 2 );
+  CHECK( cache.hits == 1 );
+  CHECK( d1.r2 == d2.r2 );
+  CHECK( d1.c == d2.c );
+  CHECK( d1.rmax2 == d2.rmax2 );
+  CHECK( an.eval(d3,10.0) == Approx(0.2).epsilon(0.01) );
+  CHECK( cache.file(an, h, true) != cache.file(an, h) );
+  CHECK( std::remove( cache.file(an, h, true).c_str() ) == 0 );
+  CHECK( std::remove( cache.file(an, h2, true).c_str() ) == 0 );
+
+  // potentials differing only below the first sample are told apart by their parameters
+  Tmjson sw1 = { {"threshold",1e-6}, {"depth",1.0} }, sw2 = { {"threshold",1.1e-6}, {"depth",1.0} };
+  Potential::SquareWell w1(sw1), w2(sw2);
+  PointParticle c;
+  c.radius = 0;
+  std::function<double(double)> f1 = [&](double r2) { return w1(c,c,r2); }, f2 = [&](double r2) { return w2(c,c,r2); };
+  an.setRange(1e-6, 100);
+  CHECK( cache.file(an, f1) == cache.file(an, f2) ); // not resolved by samples
+  CHECK( cache.file(an, f1, false, sw1.dump()) != cache.file(an, f2, false, sw2.dump()) );
 
   PointParticle a,b;
   a.charge=1;
@@ -98,6 +158,16 @@ TEST_CASE("Particles", "...")
   checkParticle<PointParticle>();
   checkParticle<DipoleParticle>();
   checkParticle<CigarParticle>();
+
+  // anisotropic properties of isotropic particles are static, read-only traits
+  static_assert( !has_dipole<PointParticle>::value, "isotropic particles have no writable dipole" );
+  static_assert( !has_dipole<CigarParticle>::value, "" );
+  static_assert( has_dipole<DipoleParticle>::value, "" );
+  const PointParticle a;
+  CHECK( a.mu().squaredNorm() == Approx(0) );
+  CHECK( a.muscalar() == Approx(0) );
+  CHECK( a.is_sphere() );
+  CHECK( sizeof(PointParticle) <= 64 );
 }
 
 TEST_CASE("Polar Test","Ion-induced dipole test (polarization)") 
@@ -190,6 +260,1045 @@ TEST_CASE("Ewald Test","Ion-Ion- and Dipole-Dipole-interaction")
   CHECK(usurf_reci == Approx(0.582251578315622*lB)); // reciprocal energy in addition to surface energy
   CHECK(uself == Approx(-0.538268271364301*lB));
   CHECK(Energy::systemEnergy(spc,pot,spc.p) == Approx(-2.0003749*lB));  // Total dipole-dipole interaction energy
+
+  // Accepted and rejected local moves keep structure factors in sync with the particles
+  for (int n = 0; n < 10; n++) {
+    spc.trial[2] = spc.p[2] + Point(0.1*n, 0.2, -0.1);
+    Tspace::Change c;
+    c.mvGroup[0].push_back(2);
+    pot.updateChange(c);
+    double du = pot.external(spc.trial) - pot.external(spc.p);
+    bool accept = (n%2==0);
+    if (accept)
+      spc.p[2] = spc.trial[2];
+    else
+      spc.trial[2] = spc.p[2];
+    pot.update(accept);
+    double u = pot.external(spc.p);
+    pot.setSpace(spc); // rebuilds structure factors from scratch
+    CHECK(u == Approx(pot.external(spc.p)));
+    CHECK(std::isfinite(du));
+  }
+}
+
+TEST_CASE("Ewald tuning", "Parameters chosen for requested accuracy")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  typedef Energy::NonbondedEwald<Tspace,Potential::HardSphere> Tewald;
+  InputMap in("unittests.json");
+  Tspace spc(in);
+  spc.p.resize(40);
+  for (size_t i=0; i<spc.p.size(); i++) {
+    spc.geo.randompos( spc.p[i] );
+    spc.p[i].charge = (i%2==0) ? 1 : -1;
+  }
+  spc.trial = spc.p;
+  Group g(0, spc.p.size()-1);
+  spc.groupList().push_back(&g);
+
+  // total energy for accuracy 'delta' (e^2/A); the cost model makes the chosen parameters reproducible
+  auto energy = [&](double delta, Tmjson &out) {
+    Tmjson j = static_cast<Tmjson&>(in);
+    j["energy"]["nonbonded"]["ewald"] = { {"eps_surf",0.0}, {"tune",true}, {"tune_cost","estimate"}, {"delta",delta} };
+    Tewald pot(j);
+    pot.setSpace(spc);
+    out = pot.json();
+    return Energy::systemEnergy(spc,pot,spc.p);
+  };
+  Tmjson coarse, fine, tmp;
+  double lB = pc::lB(1.0);
+  double uref = energy(1e-9, tmp);
+  double u1 = energy(1e-3, coarse);
+  double u2 = energy(1e-7, fine);
+  for (double delta : {1e-2, 1e-3, 1e-4, 1e-5})
+    CHECK( std::fabs(energy(delta, tmp) - uref) < delta*lB );
+  CHECK( std::fabs(u2-uref) < 1e-7*lB );
+  CHECK( double(fine["energy"]["nonbonded"]["ewald"]["delta"]) == Approx(1e-7) );
+  auto damping = [](Tmjson &j) {
+    auto &e = j["energy"]["nonbonded"]["ewald"];
+    return double(e["alpha"]) * double(e["cutoff"]);
+  };
+  CHECK( damping(coarse) < damping(fine) );
+  CHECK( energy(1e-3, tmp) == Approx(u1) ); // deterministic
+  CHECK( tmp == coarse );
+
+  // tuned parameters can be reused as input
+  Tmjson j = merge(static_cast<Tmjson&>(in), fine);
+  j["energy"]["nonbonded"]["ewald"]["eps_surf"] = 0.0;
+  Tewald pot(j);
+  pot.setSpace(spc);
+  CHECK( Energy::systemEnergy(spc,pot,spc.p) == Approx(u2) );
+}
+
+TEST_CASE("SPME", "Smooth particle-mesh Ewald vs. Ewald summation")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  typedef Energy::NonbondedSPME<Tspace,Potential::HardSphere> Tspme;
+  InputMap in("unittests.json");
+
+  // forward and backward transforms recover input
+  FFT3D fft(4,8,2);
+  vector<std::complex<double>> a(fft.size()), b;
+  for (size_t i=0; i<a.size(); i++)
+    a[i] = std::complex<double>(slump(), slump());
+  b = a;
+  fft.forward(b);
+  fft.backward(b);
+  for (size_t i=0; i<a.size(); i++)
+    CHECK( std::abs(b[i]/double(fft.size()) - a[i]) < 1e-12 );
+
+  Tspace spc(in);
+  spc.p.resize(20);
+  for (size_t i=0; i<spc.p.size(); i++) {
+    spc.geo.randompos( spc.p[i] );
+    spc.p[i].charge = (i%2==0) ? 1 : -1;
+  }
+  spc.trial = spc.p;
+  Group g(0, spc.p.size()-1);
+  spc.groupList().push_back(&g);
+
+  Tmjson j = static_cast<Tmjson&>(in);
+  j["energy"]["nonbonded"]["ewald"]["grid"] = 32;
+  j["energy"]["nonbonded"]["ewald"]["order"] = 6;
+  Tspme fresh(j);
+  j["energy"]["nonbonded"]["ewald"]["tolerance"] = 0.05;
+  Tspme spme(j);
+  Energy::NonbondedEwald<Tspace,Potential::HardSphere> ewald(in);
+  spme.setSpace(spc);
+  ewald.setSpace(spc);
+  CHECK( spme.external(spc.p) == Approx( ewald.external(spc.p) ).epsilon(1e-5) );
+  CHECK( spme.g_external(spc.p, g) == Approx( ewald.g_external(spc.p, g) ) );
+
+  // local moves and charge changes; energy change from stencils vs. full grid
+  for (int n=0; n<30; n++) {
+    Tspace::Change c;
+    int i = slump.range(0, spc.p.size()-1);
+    PointParticle old = spc.p[i];
+    spc.trial[i] = old + Point(slump.half(), slump.half(), slump.half());
+    spc.geo.boundary( spc.trial[i] );
+    if (n%4==1) // charge change, also from and to zero
+      spc.trial[i].charge = (old.charge==0) ? 1 : (n%8==1 ? 0 : -old.charge);
+    c.mvGroup[0].push_back(i);
+    spme.updateChange(c);
+    double uold = spme.external(spc.p);
+    double du = spme.external(spc.trial) - uold;
+    spc.p[i] = spc.trial[i];
+    fresh.setSpace(spc);
+    double unew = fresh.external(spc.p);
+    CHECK( std::fabs(du - (unew-uold)) < 1e-7 );
+    if (n%3==0) { // reject
+      spc.p[i] = spc.trial[i] = old;
+      spme.update(false);
+      CHECK( spme.external(spc.p) == Approx(uold) );
+    } else {
+      spme.update(true);
+      CHECK( spme.external(spc.p) == Approx(unew) );
+    }
+  }
+}
+
+TEST_CASE("Cell list", "Nonbonded energies using cell list vs. N-squared loops")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  typedef Potential::CoulombGalore Tpairpot;
+  InputMap in("unittests.json");
+  in["energy"]["celllist"] = { {"coulombtype","plain"}, {"cutoff",2.5}, {"epsr",80.0}, {"cutoff_p2p",2.5} };
+  Tspace spc(in);
+  Energy::Nonbonded<Tspace,Tpairpot> ref(in, "celllist");
+  Energy::NonbondedCellList<Tspace,Tpairpot> pot(in, "celllist");
+
+  spc.p.resize(200);
+  for (size_t i=0; i<spc.p.size(); i++) {
+    spc.geo.randompos( spc.p[i] );
+    spc.p[i].charge = (i%2==0) ? 1 : -1;
+  }
+  spc.trial = spc.p;
+  Group g1(0,99), g2(100,199);
+  spc.groupList().push_back(&g1);
+  spc.groupList().push_back(&g2);
+  ref.setSpace(spc);
+  pot.setSpace(spc);
+
+  CHECK( pot.systemEnergy(spc.p) == Approx( ref.systemEnergy(spc.p) ) );
+  CHECK( pot.g2g(spc.p, g1, g2) == Approx( ref.g2g(spc.p, g1, g2) ) );
+  CHECK( pot.g_internal(spc.p, g2) == Approx( ref.g_internal(spc.p, g2) ) );
+  for (int i : {0, 57, 199})
+    CHECK( pot.i2all(spc.p, i) == Approx( ref.i2all(spc.p, i) ) );
+
+  // single particle move: trial energies and re-binning upon acceptance
+  Tspace::Change c;
+  c.mvGroup[0].push_back(5);
+  spc.trial[5] = spc.p[5] + Point(2.1, -1.4, 0.8);
+  spc.geo.boundary( spc.trial[5] );
+  pot.updateChange(c);
+  CHECK( pot.i2all(spc.trial, 5) == Approx( ref.i2all(spc.trial, 5) ) );
+  CHECK( pot.g2All(spc.trial, c.mvGroup) == Approx( ref.g2All(spc.trial, c.mvGroup) ) );
+  CHECK( pot.g_internal(spc.trial, g1) == Approx( ref.g_internal(spc.trial, g1) ) );
+  spc.p[5] = spc.trial[5];
+  pot.update(true);
+  c.clear();
+  CHECK( pot.i2all(spc.p, 5) == Approx( ref.i2all(spc.p, 5) ) );
+  CHECK( pot.g2g(spc.p, g1, g2) == Approx( ref.g2g(spc.p, g1, g2) ) );
+
+  // rejected group move (empty index list = entire group moved)
+  c.mvGroup[1];
+  for (auto i : g2) {
+    spc.trial[i] = spc.p[i] + Point(1.5, 0, -2.5);
+    spc.geo.boundary( spc.trial[i] );
+  }
+  pot.updateChange(c);
+  CHECK( pot.g2All(spc.trial, c.mvGroup) == Approx( ref.g2All(spc.trial, c.mvGroup) ) );
+  CHECK( pot.g2g(spc.trial, g1, g2) == Approx( ref.g2g(spc.trial, g1, g2) ) );
+  spc.trial = spc.p;
+  pot.update(false);
+  CHECK( pot.systemEnergy(spc.p) == Approx( ref.systemEnergy(spc.p) ) );
+
+  // cached particle energies for single particle moves
+  in["energy"]["celllist"]["energy_cache"] = true;
+  Energy::NonbondedCellList<Tspace,Tpairpot> cached(in, "celllist");
+  cached.setSpace(spc);
+  for (int n=0; n<300; n++) {
+    int i = slump.range(0, spc.p.size()-1);
+    c.mvGroup[i<100 ? 0 : 1].push_back(i);
+    spc.trial[i] = spc.p[i] + Point(slump.half(), slump.half(), slump.half());
+    spc.geo.boundary( spc.trial[i] );
+    cached.updateChange(c);
+    CHECK( cached.i2all(spc.p, i) == Approx( ref.i2all(spc.p, i) ) );
+    CHECK( cached.i2all(spc.trial, i) == Approx( ref.i2all(spc.trial, i) ) );
+    bool accept = slump() < 0.5;
+    if (accept)
+      spc.p[i] = spc.trial[i];
+    else
+      spc.trial[i] = spc.p[i];
+    cached.update(accept);
+    c.clear();
+  }
+  CHECK( cached.info().find("cache hits") != string::npos );
+}
+
+TEST_CASE("Cell list moves", "Cached particle energies in single particle moves")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  typedef Potential::CoulombGalore Tpairpot;
+  InputMap in("unittests.json");
+  in["system"]["geometry"]["length"] = 20.0;
+  in["energy"]["celllist"] = { {"coulombtype","plain"}, {"cutoff",3.0}, {"epsr",80.0}, {"cutoff_p2p",3.0}, {"energy_cache",true} };
+  Tspace spc(in);
+  Energy::Nonbonded<Tspace,Tpairpot> ref(in, "celllist");
+  Energy::NonbondedCellList<Tspace,Tpairpot> pot(in, "celllist");
+
+  Tspace::ParticleVector ions(2), sol(2);
+  ions[0].id = atom["Na"].id;
+  ions[1].id = atom["Cl"].id;
+  sol[0].id = atom["sol1"].id;
+  sol[1].id = atom["sol2"].id;
+  for (int n=0; n<100; n++) {
+    spc.insert(spc.molecule.find("salt")->id, ions);
+    spc.insert(spc.molecule.find("multipoles")->id, sol);
+  }
+  for (size_t i=0; i<spc.p.size(); i++) {
+    spc.geo.randompos( spc.p[i] );
+    spc.p[i].charge = (i%2==0) ? 1 : -1;
+  }
+  spc.trial = spc.p;
+  CHECK( spc.groupList().size() == 2 );
+  ref.setSpace(spc);
+  pot.setSpace(spc);
+
+  Tmjson j = { {"salt", Tmjson::object()}, {"multipoles", Tmjson::object()} };
+  Move::AtomicTranslation<Tspace> mv(pot, spc, j);
+  mv.setGenericDisplacement(2.0);
+  double u0 = ref.systemEnergy(spc.p), du = 0;
+  for (int n=0; n<1000; n++)
+    du += mv.move(1);
+  CHECK( u0 + du == Approx( ref.systemEnergy(spc.p) ) );
+  CHECK( mv.getAcceptance() > 0.1 );
+  CHECK( pot.cacheHitRatio() > 0.9 ); // old configuration and unmoved particles are looked up
+}
+
+/* random accepted and rejected moves: energy matrix vs. direct evaluation */
+template<typename EType>
+void checkEnergyMatrix(double tol) {
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  typedef Energy::Nonbonded<Tspace,Potential::CoulombGalore> Tenergy;
+  InputMap in("unittests.json");
+  in["energy"]["nonbonded"] = { {"coulombtype","plain"}, {"cutoff",4.0}, {"epsr",80.0}, {"ematrix_check",25} };
+  Tspace spc(in);
+  Tenergy ref(in);
+  Energy::EnergyMatrix<EType,Tspace,Tenergy> pot(in);
+
+  spc.p.resize(55);
+  for (size_t i=0; i<spc.p.size(); i++) {
+    spc.geo.randompos( spc.p[i] );
+    spc.p[i].charge = (i%2==0) ? 1 : -1;
+  }
+  spc.trial = spc.p;
+  Group m1(0,4), m2(5,9), m3(10,14), salt(15,54); // three flexible molecules and salt
+  for (auto g : {&m1, &m2, &m3}) {
+    g->setMolSize(5);
+    spc.groupList().push_back(g);
+  }
+  salt.setMolSize(1);
+  spc.groupList().push_back(&salt);
+  ref.setSpace(spc);
+  pot.setSpace(spc);
+  CHECK( pot.systemEnergy(spc.p) == Approx( ref.systemEnergy(spc.p) ).epsilon(tol) );
+
+  Tspace::Change c;
+  for (int n=0; n<200; n++) {
+    int type = n % 4, mol = slump.range(0, 2);
+    int ion = slump.range(salt.front(), salt.back());
+    if (type==0 || type==3)
+      c.mvGroup[3].push_back(ion);                      // single salt particle
+    if (type==1 || type==3)
+      c.mvGroup[mol];                                   // entire molecule
+    if (type==2)
+      c.mvGroup[mol].push_back(5*mol + n%5);            // single atom in molecule
+    for (auto &m : c.mvGroup) {
+      Point d(slump.half(), slump.half(), slump.half());
+      vector<int> moved = m.second;
+      if (moved.empty()) // rigid translation
+        moved.assign(spc.groupList()[m.first]->begin(), spc.groupList()[m.first]->end());
+      for (int i : moved) {
+        spc.trial[i] = spc.p[i] + d;
+        spc.geo.boundary( spc.trial[i] );
+      }
+    }
+    double du = Energy::energyChange(spc, ref, c);
+    CHECK( Energy::energyChange(spc, pot, c) == Approx(du).epsilon(tol) );
+    bool accept = slump() < 0.5;
+    if (accept)
+      spc.p = spc.trial;
+    else
+      spc.trial = spc.p;
+    pot.update(accept);
+    c.clear();
+  }
+  CHECK( pot.systemEnergy(spc.p) == Approx( ref.systemEnergy(spc.p) ).epsilon(tol) );
+  CHECK( pot.g2g(spc.p, m1, salt) == Approx( ref.g2g(spc.p, m1, salt) ).epsilon(tol) );
+  CHECK( pot.g_internal(spc.p, m2) == Approx( ref.g_internal(spc.p, m2) ).epsilon(tol) );
+
+  // accepted change not evaluated through the cache, e.g. by a move using i2i()
+  spc.p[20].charge = spc.trial[20].charge = -spc.p[20].charge;
+  pot.update(true);
+  CHECK( pot.systemEnergy(spc.p) == Approx( ref.systemEnergy(spc.p) ).epsilon(tol) );
+}
+
+TEST_CASE("Energy matrix", "Cached group energies for molecules and salt")
+{
+  checkEnergyMatrix<double>(1e-9);
+  checkEnergyMatrix<float>(1e-4);
+
+  // caches are modified by energy functions so tiled blocks must not run concurrently
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  typedef Energy::Nonbonded<Tspace,Potential::Coulomb> Tenergy;
+  InputMap in("unittests.json");
+  in["energy"]["nonbonded"] = { {"epsr",80.0} };
+  in["moves"]["isobaric"] = { {"pressure",20.0} };
+  auto pot = Energy::EnergyMatrix<double,Tspace,Tenergy>(in) + Energy::ExternalPressure<Tspace>(in);
+  CHECK( Tenergy(in).isReentrant() );
+  CHECK_FALSE( pot.isReentrant() );
+  CHECK_FALSE( (Energy::EnergyMatrix<double,Tspace,Energy::NonbondedCutg2g<Tspace,Potential::Coulomb>>(in).isReentrant()) );
+}
+
+TEST_CASE("Bonded", "Bond energies from CSR topology vs. pair potentials")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  InputMap in("unittests.json");
+  Tspace spc(in);
+  spc.p.resize(6);
+  for (size_t i=0; i<spc.p.size(); i++)
+    spc.p[i] = Point(0.5*i, 0.2*i*i, 0);
+  spc.trial = spc.p;
+  Group g(0,3);
+  spc.groupList().push_back(&g);
+
+  Energy::Bonded<Tspace> pot;
+  pot.setSpace(spc);
+  Potential::Harmonic harmonic(0.5, 1.0);
+  Potential::FENE fene(2.0, 4.0);
+  auto other = Potential::Harmonic(0.2, 0.5) + Potential::Harmonic(0.1, 2.0);
+  pot.add(0, 1, harmonic);
+  pot.add(2, 1, fene);
+  pot.add(1, 3, other);
+  pot.add(3, 4, harmonic); // crosses group boundary
+  pot.add(0, 1, fene);     // replaces harmonic bond
+
+  auto &p = spc.p;
+  auto r2 = [&](int i, int j) { return spc.geo.sqdist(p[i], p[j]); };
+  double u01 = fene(p[0], p[1], r2(0,1)), u12 = fene(p[1], p[2], r2(1,2));
+  double u13 = other(p[1], p[3], r2(1,3)), u34 = harmonic(p[3], p[4], r2(3,4));
+  CHECK( pot.i2i(p, 1, 0) == Approx(u01) );
+  CHECK( pot.i2i(p, 1, 2) == Approx(u12) );
+  CHECK( pot.i2i(p, 3, 1) == Approx(u13) );
+  CHECK( pot.i2i(p, 0, 2) == 0 );
+  CHECK( pot.i2i(p, 5, 0) == 0 );
+  CHECK( pot.i2all(p, 1) == Approx(u01 + u12 + u13) );
+  CHECK( pot.i2all(p, 5) == 0 );
+  CHECK( pot.g_internal(p, g) == Approx(u01 + u12 + u13) );
+  CHECK( pot.total(p) == Approx(u01 + u12 + u13 + u34) );
+  CHECK( pot.getBondList().size() == 4 );
+
+  p[0] = Point(0, 0, 5); // FENE beyond maximum separation
+  CHECK( pot.i2all(p, 0) == pc::infty );
+  pot.clear();
+  CHECK( pot.total(p) == 0 );
+}
+
+TEST_CASE("Manybody", "Angular and dihedral terms evaluated via particle index")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  InputMap in("unittests.json");
+  Tspace spc(in);
+  spc.p.resize(6);
+  spc.p[0] = Point(0,1,0);
+  spc.p[1] = Point(0,0,0);
+  spc.p[2] = Point(1,0,0);
+  spc.p[3] = Point(1,1,0);
+  spc.p[4] = Point(2,0,1);
+  spc.p[5] = Point(3,1,1);
+  spc.trial = spc.p;
+  Group g(0,5);
+  spc.groupList().push_back(&g);
+
+  Potential::Angular angle( {0,1,2}, 70., 0.5 );
+  Potential::Dihedral cis( {0,1,2,3}, 1.2, 1, 0. );
+  CHECK( angle(spc.geo, spc.p) == Approx( 0.5*std::pow(20*pc::pi/180, 2) ) );
+  CHECK( Potential::Dihedral::angle(spc.geo, spc.p, 0,1,2,3) == Approx(0) );
+  CHECK( cis(spc.geo, spc.p) == Approx(2.4) );
+
+  Energy::Manybody<Tspace> pot(spc);
+  pot.add( angle );
+  pot.add( cis );
+  pot.add( Potential::Angular( {3,4,5}, 120., 0.3 ) );
+  pot.add( Potential::Dihedral( {2,3,4,5}, 0.7, 3, 10. ) );
+  struct Generic { // functor stored as generic term
+    Potential::Angular a;
+    std::vector<int> getIndex() const { return a.getIndex(); }
+    string brief() const { return a.brief(); }
+    double operator()(Geometry::Cuboid &geo, const Tspace::ParticleVector &p) const { return a(geo,p); }
+  };
+  pot.add( Generic{ Potential::Angular( {1,2,3}, 90., 0.1 ) } );
+
+  auto full = [&](const Tspace::ParticleVector &p) {
+    double u=0;
+    for (auto &t : {angle, Potential::Angular({3,4,5}, 120., 0.3), Potential::Angular({1,2,3}, 90., 0.1)})
+      u += t(spc.geo, p);
+    for (auto &t : {cis, Potential::Dihedral({2,3,4,5}, 0.7, 3, 10.)})
+      u += t(spc.geo, p);
+    return u;
+  };
+  CHECK( pot.external(spc.p) == Approx( full(spc.p) ) );
+
+  for (int n=0; n<50; n++) {
+    int i = slump.range(0,5);
+    Tspace::Change c;
+    c.mvGroup[0].push_back(i);
+    pot.updateChange(c);
+    spc.trial[i] = spc.p[i] + Point(slump()-0.5, slump()-0.5, slump()-0.5);
+    double du = pot.external(spc.trial) - pot.external(spc.p);
+    CHECK( du == Approx( full(spc.trial) - full(spc.p) ) );
+    CHECK( pot.numTouched() == (i==1 ? 3 : (i==2 || i==3) ? 4 : 2) );
+    bool acc = (n%2==0);
+    if (acc)
+      spc.p[i] = spc.trial[i];
+    else
+      spc.trial[i] = spc.p[i];
+    pot.update(acc);
+  }
+  CHECK( pot.external(spc.p) == Approx( full(spc.p) ) );
+
+  Tspace::Change c; // entire group moved
+  c.mvGroup[0];
+  pot.updateChange(c);
+  CHECK( pot.numTouched() == 5 );
+  pot.update(false);
+}
+
+TEST_CASE("SASA", "Incremental surface areas vs. full recalculation")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  InputMap in("unittests.json");
+  in["system"]["geometry"]["length"] = 30.0;
+  in["energy"]["sasa"] = { {"proberadius",1.4}, {"conc",0.5}, {"points",200} };
+  Tspace spc(in);
+
+  // isolated sphere and two overlapping spheres (analytic cap)
+  SASA::ShrakeRupley sasa(1.4, 200);
+  spc.p.resize(2);
+  spc.p[0] = spc.p[1] = Point(0,0,0);
+  spc.p[0].radius = 1.6;
+  spc.p[1].radius = 0.6;
+  spc.p[1].x() = 3.5;
+  sasa.build(spc.geo, spc.p);
+  double R=3, Rj=2, d=3.5, h = R - (d*d + R*R - Rj*Rj) / (2*d);
+  CHECK( sasa.areas()[0] == Approx( 4*pc::pi*R*R - 2*pc::pi*R*h ).epsilon(0.02) );
+  spc.p[1].x() = 5.01;
+  sasa.build(spc.geo, spc.p);
+  CHECK( sasa.areas()[0] == Approx( 4*pc::pi*R*R ) );
+
+  auto na = atom["Na"].id, cl = atom["Cl"].id;
+  double tfe_na = atom[na].tfe, tfe_cl = atom[cl].tfe;
+  atom[na].tfe = 400;
+  atom[cl].tfe = -150;
+
+  spc.p.resize(60);
+  for (size_t i=0; i<spc.p.size(); i++) {
+    spc.geo.randompos( spc.p[i] );
+    spc.p[i].radius = 1 + (i%3) * 0.5;
+    spc.p[i].id = (i%2==0) ? na : cl;
+  }
+  spc.trial = spc.p;
+  Group g1(0,39), g2(40,59);
+  spc.groupList().push_back(&g1);
+  spc.groupList().push_back(&g2);
+
+  Energy::SASAEnergy<Tspace> pot(in, "sasa");
+  pot.setSpace(spc);
+  auto full = [&](const Tspace::ParticleVector &p) {
+    SASA::ShrakeRupley ref(1.4, 200);
+    ref.build(spc.geo, p);
+    double u=0;
+    for (size_t i=0; i<p.size(); i++) {
+      CHECK( ref.areas()[i] == Approx( ref.areaOf(spc.geo, p, i) ) ); // grid vs. N-squared
+      u += ref.areas()[i] * atom[p[i].id].tfe / (pc::kT()*pc::Nav);
+    }
+    return 0.5*u;
+  };
+  CHECK( pot.external(spc.p) == Approx( full(spc.p) ) );
+
+  for (int n=0; n<20; n++) {
+    Tspace::Change c;
+    if (n%5==4) {
+      c.mvGroup[1]; // entire group
+      for (auto i : g2)
+        spc.trial[i] = spc.p[i] + Point(0.5, -0.3, 0.2);
+    } else {
+      int i = slump.range(0, 59);
+      c.mvGroup[i<40 ? 0 : 1].push_back(i);
+      spc.trial[i] = spc.p[i] + 3*Point(slump()-0.5, slump()-0.5, slump()-0.5);
+    }
+    for (auto &a : spc.trial)
+      spc.geo.boundary(a);
+    pot.updateChange(c);
+    CHECK( pot.external(spc.trial) == Approx( full(spc.trial) ) );
+    bool acc = (n%3!=0);
+    if (acc)
+      spc.p = spc.trial;
+    else
+      spc.trial = spc.p;
+    pot.update(acc);
+    CHECK( pot.external(spc.p) == Approx( full(spc.p) ) );
+  }
+  // particle moved outside updateChange()/update(), e.g. by loading a configuration
+  spc.p[17] = spc.p[18] + Point(1.0, 0, 0);
+  spc.geo.boundary( spc.p[17] );
+  spc.trial = spc.p;
+  CHECK( pot.external(spc.p) == Approx( full(spc.p) ) );
+
+  auto A = pot.areas();
+  for (int i : {0, 17, 59})
+    CHECK( A[i] == Approx( sasa.areaOf(spc.geo, spc.p, i) ) );
+
+  atom[na].tfe = tfe_na;
+  atom[cl].tfe = tfe_cl;
+}
+
+TEST_CASE("Cluster move", "Molecule and surrounding ions moved together")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  InputMap in("unittests.json");
+  in["system"]["geometry"]["length"] = 40.0;
+  in["energy"]["nonbonded"] = { {"coulombtype","plain"}, {"cutoff",8.0}, {"epsr",80.0} };
+  Tspace spc(in);
+  Energy::Nonbonded<Tspace,Potential::CoulombGalore> pot(in);
+
+  int salt = spc.molecule.find("salt")->id;
+  int square = spc.molecule.find("square")->id;
+  Tspace::ParticleVector ions(2), mm(4);
+  ions[0].id = atom["Na"].id;
+  ions[1].id = atom["Cl"].id;
+  for (auto &a : mm)
+    a.id = atom["MM"].id;
+  spc.insert(square, mm);
+  for (int n=0; n<40; n++)
+    spc.insert(salt, ions);
+  Group *g = spc.findMolecules(square).front();
+  for (size_t i=0; i<spc.p.size(); i++) {
+    spc.p[i].charge = (i%2==0) ? 1 : -1;
+    if (g->find(i))
+      spc.p[i] = Point(i, 0, 0);
+    else
+      spc.geo.randompos( spc.p[i] );
+  }
+  spc.trial = spc.p;
+  g->setMassCenter(spc);
+  pot.setSpace(spc);
+
+  // energy drift with and without pair cutoff
+  for (double cutoff : {8.0, pc::infty}) {
+    Tmjson j = { {"square", { {"clustergroup","salt"}, {"threshold",4.0}, {"dp",4.0}, {"dprot",1.0} }} };
+    if (cutoff < pc::infty)
+      j["square"]["cutoff"] = cutoff;
+    Move::TranslateRotateCluster<Tspace> mv(pot, spc, j);
+    double u0 = pot.systemEnergy(spc.p), du = 0;
+    for (int n=0; n<100; n++)
+      du += mv.move(1);
+    CHECK( u0 + du == Approx( pot.systemEnergy(spc.p) ) );
+    CHECK( (spc.p[g->front()] - spc.trial[g->front()]).norm() == Approx(0) );
+    CHECK( mv.info().find("Average cluster size") != string::npos );
+  }
+  CHECK( spc.geo.sqdist(g->massCenter(spc), g->cm) < 1e-9 );
+}
+
+TEST_CASE("Homogeneous scaling", "Volume move energies from scaled homogeneous terms")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  typedef Potential::CoulombLJ Tpairpot;
+  InputMap in("unittests.json");
+  in["system"]["geometry"]["length"] = 30.0;
+  in["energy"]["homogeneous"] = { {"epsr",80.0}, {"eps",0.5} };
+  in["moves"]["isobaric"] = { {"dp",0.2}, {"pressure",20.0} };
+  Tspace spc(in);
+
+  // pair potential split into r^-1, r^-12 and r^-6 terms
+  CHECK( int(Potential::homogeneous<Tpairpot>::size) == 3 );
+  CHECK( Potential::homogeneous<Tpairpot>::exponent(0) == 1 );
+  CHECK( Potential::homogeneous<Tpairpot>::exponent(2) == 6 );
+  CHECK( int(Potential::homogeneous<Potential::CoulombWolf>::size) == 0 );
+  Tpairpot pairpot(in["energy"]["homogeneous"]);
+  PointParticle a, b;
+  a.charge = 1; b.charge = -1;
+  a.radius = b.radius = 1.5;
+  double u[3] = {0, 0, 0};
+  pairpot.terms(a, b, 12.0, u);
+  CHECK( u[0] + u[1] + u[2] == Approx( pairpot(a, b, 12.0) ) );
+
+  int salt = spc.molecule.find("salt")->id;
+  Tspace::ParticleVector ions(2);
+  ions[0].id = atom["Na"].id;
+  ions[1].id = atom["Cl"].id;
+  for (int n=0; n<32; n++)
+    spc.insert(salt, ions);
+  for (int i=0; i<64; i++) { // simple cubic lattice
+    spc.p[i] = Point( Point(i%4, (i/4)%4, i/16) * 7.5 - Point(15, 15, 15) + Point(0.1, 0.2, 0.3) * (i%3) );
+    spc.p[i].charge = (i%2==0) ? 1 : -1;
+    spc.p[i].radius = 1.5;
+  }
+  spc.trial = spc.p;
+
+  auto pot = Energy::NonbondedHomogeneous<Tspace,Tpairpot>(in, "homogeneous") + Energy::ExternalPressure<Tspace>(in);
+  auto ref = Energy::Nonbonded<Tspace,Tpairpot>(in, "homogeneous") + Energy::ExternalPressure<Tspace>(in);
+  auto &nb = *std::get<0>( pot.tuple() );
+  pot.setSpace(spc);
+  ref.setSpace(spc);
+  CHECK( std::isnan( ref.scaleChange(1.1) ) ); // plain Nonbonded: recalculate
+
+  Move::Isobaric<Tspace> iso(pot, spc, in["moves"]["isobaric"]);
+  Tmjson j = { {"salt", { {"peratom",true} }} };
+  Move::AtomicTranslation<Tspace> mv(pot, spc, j);
+
+  // volume moves with and without particle moves in between
+  double u0 = ref.systemEnergy(spc.p), du = 0;
+  for (int n=0; n<60; n++) {
+    du += iso.move(1);
+    if (n%3==0 && n<30)
+      du += mv.move(1);
+  }
+  ref.setSpace(spc); // copy of new geometry
+  CHECK( u0 + du == Approx( ref.systemEnergy(spc.p) ) );
+  double upair = std::accumulate(nb.terms().begin(), nb.terms().end(), 0.0);
+  CHECK( upair == Approx( ref.first.systemEnergy(spc.p) ) );
+  CHECK( nb.info().find("Term summations") != string::npos );
+}
+
+TEST_CASE("System energy", "Tiled summation over groups vs. pair loop")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  typedef Energy::Nonbonded<Tspace,Potential::Coulomb> Tenergy;
+  InputMap in("unittests.json");
+  in["system"]["geometry"]["length"] = 40.0;
+  in["energy"]["tiled"] = { {"epsr",80.0} };
+  Tspace spc(in);
+  Tenergy pot(in, "tiled");
+
+  spc.p.resize(400);
+  for (size_t i=0; i<spc.p.size(); i++) {
+    spc.geo.randompos( spc.p[i] );
+    spc.p[i].charge = (i%2==0) ? 1 : -1;
+  }
+  spc.trial = spc.p;
+  pot.setSpace(spc);
+  CHECK( pot.isReentrant() );
+
+  double ref = 0;
+  for (size_t i=0; i<spc.p.size(); i++)
+    for (size_t j=i+1; j<spc.p.size(); j++)
+      ref += pot.i2i(spc.p, i, j);
+
+  // one atomic group, then 80 molecules spanning several blocks
+  Group salt(0,399);
+  salt.setMolSize(1);
+  spc.groupList().push_back(&salt);
+  CHECK( pot.systemEnergy(spc.p) == Approx(ref) );
+
+  spc.groupList().clear();
+  vector<Group> mol;
+  for (int k=0; k<80; k++)
+    mol.push_back( Group(5*k, 5*k+4) );
+  for (auto &g : mol) {
+    g.setMolSize(5);
+    spc.groupList().push_back(&g);
+  }
+  double u = pot.systemEnergy(spc.p);
+  CHECK( u == Approx(ref) );
+  CHECK( pot.g2g(spc.p, mol[0], mol[1]) == Approx( pot.g1g2(spc.p, mol[0], spc.p, mol[1]) ) );
+
+  // moved groups against all others, also in blocks of groups
+  ChangeMap<vector<int>> mg;
+  mg[3];
+  mg[50];
+  double ug = pot.g2g(spc.p, mol[3], mol[3]) + pot.g2g(spc.p, mol[3], mol[50]) + pot.g2g(spc.p, mol[50], mol[50]);
+  for (int k=0; k<80; k++)
+    if (k!=3 && k!=50)
+      ug += pot.g2g(spc.p, mol[3], mol[k]) + pot.g2g(spc.p, mol[50], mol[k]);
+  CHECK( pot.g2All(spc.p, mg) == Approx(ug) );
+
+#ifdef _OPENMP
+  int nthreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  double u1 = pot.systemEnergy(spc.p), g1 = pot.g_internal(spc.p, salt);
+  double a1 = pot.g2All(spc.p, mg);
+  omp_set_num_threads(4);
+  CHECK( pot.systemEnergy(spc.p) == u1 ); // bit-identical
+  CHECK( pot.g2All(spc.p, mg) == a1 );
+  CHECK( pot.g_internal(spc.p, salt) == g1 );
+  omp_set_num_threads(nthreads);
+#endif
+}
+
+/* compare batched pair energies with one-pair-at-a-time evaluation */
+template<class Tpairpot, class Tpvec>
+void checkBatch(Tpairpot &pot, const Tpvec &p) {
+  CHECK( Potential::is_batched<Tpairpot>::value );
+  int n = p.size()-1;
+  vector<double> r2(n), charge(n), radius(n), u(n);
+  vector<int> id(n);
+  for (int k=0; k<n; k++) {
+    r2[k] = (p[0]-p[k+1]).squaredNorm();
+    charge[k] = p[k+1].charge;
+    radius[k] = p[k+1].radius;
+    id[k] = p[k+1].id;
+  }
+  Potential::PairBlock b = {r2.data(), charge.data(), radius.data(), id.data(), n};
+  pot.batch(p[0], b, u.data());
+  for (int k=0; k<n; k++)
+    CHECK( u[k] == Approx( pot(p[0], p[k+1], r2[k]) ) );
+}
+
+TEST_CASE("Batched pair potentials", "Batched vs. pair-wise energy evaluation")
+{
+  using namespace Potential;
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  InputMap in("unittests.json");
+  in["energy"]["batch"] = { {"epsr",80.0}, {"eps",0.5}, {"debyelength",10.0},
+    {"coulombtype","yukawa"}, {"cutoff",4.0} };
+  Tspace spc(in);
+  spc.p.resize(600);
+  for (size_t i=0; i<spc.p.size(); i++) {
+    spc.geo.randompos( spc.p[i] );
+    spc.p[i].charge = (i%2==0) ? 1 : -0.5;
+    spc.p[i].radius = 1 + 0.1*(i%3);
+    spc.p[i].id = atom[ (i%2==0) ? "Na" : "MM" ].id;
+  }
+  Tmjson &j = in["energy"]["batch"];
+
+  LennardJones lj(j);
+  LennardJonesLB ljmix(j);
+  ljmix.customEpsilon( atom["Na"].id, atom["MM"].id, 0.3 );
+  ljmix.customSigma( atom["Na"].id, atom["MM"].id, 2.5 );
+  Coulomb coulomb(j);
+  DebyeHuckel dh(j);
+  CoulombGalore galore(j);
+  CoulombGaloreTabulate<Tabulate::Uniform<double>> galoreUniform(j);
+  CombinedPairPotential<LennardJones,Coulomb> ljcoulomb(j);
+  for (size_t i=1; i<spc.p.size(); i++)
+    CHECK( galoreUniform(spc.p[0], spc.p[i], spc.p[i]-spc.p[0]) == Approx(galore(spc.p[0], spc.p[i], spc.p[i]-spc.p[0])) );
+  checkBatch(lj, spc.p);
+  checkBatch(ljmix, spc.p);
+  checkBatch(coulomb, spc.p);
+  checkBatch(dh, spc.p);
+  checkBatch(galore, spc.p);
+  checkBatch(galoreUniform, spc.p);
+  checkBatch(ljcoulomb, spc.p);
+  CHECK( !is_batched<CutShift<LennardJones>>::value );
+  CHECK( !is_batched<CoulombWolf>::value );
+
+  // Nonbonded dispatches to batched kernels over blocks larger than PairBlock::capacity
+  Energy::Nonbonded<Tspace,DebyeHuckel> pot(in, "batch");
+  pot.setSpace(spc);
+  Group g1(0,99), g2(100,599);
+  double u=0;
+  for (auto i : g1)
+    for (auto j : g2)
+      u += pot.p2p(spc.p[i], spc.p[j]);
+  CHECK( pot.g2g(spc.p, g1, g2) == Approx(u) );
+  CHECK( pot.g2g(spc.p, g2, g1) == Approx(u) );
+  u=0;
+  for (size_t i=0; i<spc.p.size(); i++)
+    if (i!=300)
+      u += pot.p2p(spc.p[300], spc.p[i]);
+  CHECK( pot.i2all(spc.p, 300) == Approx(u) );
+
+  // distances and partner properties from structure-of-arrays mirror
+  spc.trial = spc.p;
+  spc.enableArrays();
+  CHECK( pot.i2all(spc.trial, 300) == Approx(u) );
+}
+
+/* harmonic restraint along z used to test external energies */
+struct HarmonicZ : public Potential::ExternalPotentialBase<> {
+  double k;
+  HarmonicZ(Tmjson &j) : k(j.value("k", 1.0)) { name="Harmonic z"; }
+  string _info() override { return name; }
+  template<class Tparticle>
+    double operator()(const Tparticle &a) const { return 0.5*k*a.z()*a.z(); }
+};
+
+TEST_CASE("Potential map", "Pair potentials dispatched on atom types")
+{
+  using namespace Potential;
+  InputMap in("unittests.json");
+  Tmjson j = { {"epsr",80.0}, {"eps",0.2} };
+  auto na = atom["Na"].id, cl = atom["Cl"].id, mm = atom["MM"].id;
+  PointParticle a, b, c;
+  a = atom[na];
+  b = atom[cl];
+  c = atom[mm];
+  a.charge = 1;
+  b.charge = -1;
+  c.charge = 1;
+  a.radius = b.radius = c.radius = 2;
+
+  Coulomb coulomb(j);
+  LennardJones lj(j);
+  PotentialMap<Coulomb> m(j);
+  m.add(na, cl, CombinedPairPotential<Coulomb,LennardJones>(j));
+  m.add(mm, mm, lj);
+  for (double r2 : {9.0, 20.0, 100.0}) {
+    CHECK( m(a, c, r2) == Approx( coulomb(a, c, r2) ) );  // default
+    CHECK( m(a, b, r2) == Approx( coulomb(a, b, r2) + lj(a, b, r2) ) );
+    CHECK( m(b, a, r2) == Approx( m(a, b, r2) ) );
+    CHECK( m(c, c, r2) == Approx( lj(c, c, r2) ) );
+  }
+  CHECK( (m.force(a, b, 9.0, Point(3,0,0)) - lj.force(a, b, 9.0, Point(3,0,0)) - coulomb.force(a, b, 9.0, Point(3,0,0))).norm() < 1e-9 );
+
+  // tabulated pairs use the spline within range and the potential outside
+  m.tabulate(mm, mm, 2.5, 10.0, 1e-6);
+  for (double r = 2.6; r < 10; r += 0.1)
+    CHECK( std::fabs( m(c, c, r*r) - lj(c, c, r*r) ) < 1e-6 );
+  CHECK( m(c, c, 4.0) == Approx( lj(c, c, 4.0) ) );
+  CHECK( m(a, b, 9.0) == Approx( coulomb(a, b, 9.0) + lj(a, b, 9.0) ) );
+  CHECK_THROWS( m.tabulate(na, na, 2.5, 10.0, 1e-6) );
+}
+
+TEST_CASE("Static Hamiltonian", "Compile-time composition vs. operator+")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  typedef Energy::Nonbonded<Tspace,Potential::Coulomb> Tnonbonded;
+  typedef Energy::ExternalPotential<Tspace,HarmonicZ> Texternal;
+  InputMap in("unittests.json");
+  in["energy"]["static"] = { {"epsr",80.0}, {"k",0.3} };
+  Tspace spc(in);
+  spc.p.resize(40);
+  for (size_t i=0; i<spc.p.size(); i++) {
+    spc.geo.randompos( spc.p[i] );
+    spc.p[i].charge = (i%2==0) ? 1 : -1;
+  }
+  spc.trial = spc.p;
+  Group g1(0,19), g2(20,39);
+  spc.groupList().push_back(&g1);
+  spc.groupList().push_back(&g2);
+
+  Tnonbonded nb(in, "static");
+  Texternal ext(in["energy"]["static"]);
+  auto &ref = nb + ext + Texternal(in["energy"]["static"]);
+  auto pot = Energy::makeHamiltonian(nb, ext, Texternal(in["energy"]["static"]));
+  ref.setSpace(spc);
+  pot.setSpace(spc);
+
+  CHECK( Energy::is_particle_external<Texternal>::value );
+  CHECK( !Energy::is_particle_external<Tnonbonded>::value );
+  CHECK( Energy::is_pair_term<Tnonbonded>::value );
+  CHECK( !Energy::is_pair_term<Texternal>::value );
+  CHECK( std::get<0>( pot.tuple() ) == &pot.terms.first );
+  CHECK( std::tuple_size<decltype(pot.tuple())>::value == 3 );
+
+  Energy::Energybase<Tspace> &u = pot; // virtual call only at the top level
+  CHECK( u.g_external(spc.p, g1) == Approx( ref.g_external(spc.p, g1) ) );
+  CHECK( u.g_internal(spc.p, g2) == Approx( ref.g_internal(spc.p, g2) ) );
+  CHECK( u.g2g(spc.p, g1, g2) == Approx( ref.g2g(spc.p, g1, g2) ) );
+  CHECK( u.i_total(spc.p, 7) == Approx( ref.i_total(spc.p, 7) ) );
+  CHECK( u.systemEnergy(spc.p) == Approx( ref.systemEnergy(spc.p) ) );
+  ChangeMap<vector<int>> mg = { {0, {}} };
+  CHECK( u.g2All(spc.p, mg) == Approx( ref.g2All(spc.p, mg) ) );
+
+  // fused loop with particles outside groups and groups out of order
+  Group g3(0,9), g4(25,39), g5(20,24);
+  spc.groupList() = { &g4, &g3, &g5 };
+  CHECK( u.systemEnergy(spc.p) == Approx( ref.systemEnergy(spc.p) ) );
+  for (int i : {0, 15, 39})
+    CHECK( u.i_total(spc.p, i) == Approx( ref.i_total(spc.p, i) ) );
+  spc.groupList().push_back(&g1); // overlapping groups
+  CHECK( u.systemEnergy(spc.p) == Approx( ref.systemEnergy(spc.p) ) );
+}
+
+TEST_CASE("Particle arrays", "Structure-of-arrays mirror of particle vectors")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  InputMap in("unittests.json");
+  Tspace spc(in);
+  spc.p.resize(10);
+  for (size_t i=0; i<spc.p.size(); i++) {
+    spc.geo.randompos( spc.p[i] );
+    spc.p[i].charge = i;
+  }
+  spc.trial = spc.p;
+  Group g(0,9);
+  spc.groupList().push_back(&g);
+
+  CHECK( !spc.hasArrays() );
+  spc.enableArrays();
+  CHECK( spc.arrays(spc.p).size() == 10 );
+  CHECK( spc.arrays(spc.trial).charge[7] == Approx(7) );
+
+  // rejected move
+  Tspace::Change c;
+  c.mvGroup[0].push_back(3);
+  spc.trial[3] = Point(1,2,3);
+  spc.syncArrays(c);
+  CHECK( spc.arrays_trial.y[3] == Approx(2) );
+  CHECK( spc.arrays_p.y[3] == Approx( spc.p[3].y() ) );
+  spc.trial[3] = spc.p[3];
+  spc.undoArrays(c);
+  CHECK( spc.arrays_trial.y[3] == Approx( spc.p[3].y() ) );
+
+  // accepted move of entire group
+  c.clear();
+  c.mvGroup[0];
+  for (auto i : g)
+    spc.trial[i].z() = 0.5*i;
+  spc.syncArrays(c);
+  for (auto i : g)
+    spc.p[i] = spc.trial[i];
+  spc.acceptArrays(c);
+  for (auto i : g)
+    CHECK( spc.arrays_p.z[i] == Approx(0.5*i) );
+}
+
+/** @brief Compare `Space` group lookup tables with linear searches */
+template<class Tspace>
+void checkGroupLookup( Tspace &spc )
+{
+  for (int i=0; i<(int)spc.p.size(); i++) {
+    Group *ref = nullptr;
+    for (auto g : spc.groupList())
+      if (g->find(i)) {
+        ref = g;
+        break;
+      }
+    CHECK( spc.findGroup(i) == ref );
+  }
+  for (int k=0; k<(int)spc.groupList().size(); k++)
+    CHECK( spc.findIndex( spc.groupList()[k] ) == k );
+}
+
+TEST_CASE("Group lookup", "Particle -> group and group -> index tables in Space")
+{
+  typedef Space<Geometry::Cuboid,PointParticle> Tspace;
+  InputMap in("unittests.json");
+  Tspace spc(in);
+
+  int salt = spc.molecule.find("salt")->id;
+  int square = spc.molecule.find("square")->id;
+  Tspace::ParticleVector ions(2), mm(4);
+  ions[0].id = atom["Na"].id;
+  ions[1].id = atom["Cl"].id;
+  for (auto &a : mm)
+    a.id = atom["MM"].id;
+
+  spc.insert(square, mm);
+  spc.insert(salt, ions);
+  spc.insert(salt, ions); // appended to existing salt group
+  spc.insert(square, mm);
+  CHECK( spc.groupList().size() == 3 );
+  CHECK( spc.p.size() == 12 );
+  checkGroupLookup(spc);
+  CHECK( spc.findGroup(12) == nullptr );
+
+  Group external(0,0);
+  CHECK( spc.findIndex(&external) == -1 );
+
+  spc.eraseGroup(0);
+  checkGroupLookup(spc);
+
+  spc.erase(2); // salt particle
+  checkGroupLookup(spc);
+
+  spc.insert(ions[0], 1);
+  checkGroupLookup(spc);
+
+  // swap erase: last ion of the salt group fills the slot
+  spc.insert(salt, ions);
+  Group *g = spc.findMolecules(salt).front();
+  int n = g->size(), i = g->front(), last = g->back();
+  auto moved = spc.p[last];
+  spc.eraseSwap(i);
+  CHECK( g->size() == n-1 );
+  CHECK( spc.p[i].id == moved.id );
+  CHECK( (spc.p[i] - moved).norm() == Approx(0) );
+  CHECK( spc.atomTrack.size() == spc.p.size() );
+  for (size_t k=0; k<spc.p.size(); k++)
+    CHECK( spc.atomTrack.exists(spc.p[k].id, k) );
+  checkGroupLookup(spc);
+
+  spc.eraseGroup( spc.findIndex( spc.findGroup(0) ) );
+  checkGroupLookup(spc);
+}
+
+TEST_CASE("Change set", "Flat map used by Space::Change")
+{
+  ChangeMap<vector<int>> m;
+  m[5].push_back(1);
+  m[2];
+  m[9] = {3,4};
+  CHECK( m.size() == 3 );
+  CHECK( m.begin()->first == 2 );
+  CHECK( (m.end()-1)->first == 9 );
+  CHECK( m.count(5) == 1 );
+  CHECK( m.count(3) == 0 );
+  CHECK( m.find(3) == m.end() );
+  CHECK( m.at(9).size() == 2 );
+
+  ChangeMap<vector<int>> copy;
+  copy = m;
+  CHECK( copy.size() == 3 );
+  CHECK( copy.at(5)[0] == 1 );
+
+  CHECK( m.erase(5) == 1 );
+  CHECK( m.erase(5) == 0 );
+  CHECK( m.size() == 2 );
+  CHECK( m.begin()->first == 2 );
+
+  // memory is kept for reuse after clear()
+  m.clear();
+  CHECK( m.empty() );
+  m[7].reserve(100);
+  const int *data = m[7].data();
+  m.clear();
+  m[7].push_back(1);
+  CHECK( m[7].data() == data );
+  CHECK( m[7].size() == 1 );
 }
 
 TEST_CASE("Groups", "Check group range and size properties")
@@ -261,6 +1370,52 @@ TEST_CASE("Geometries", "Geometry tests")
   CHECK( x==Approx(y) );
 }
 
+/* compare batched and point-by-point distances and minimum image */
+template<class Tgeometry>
+void checkMinimumImage(Tgeometry &geo) {
+  CHECK( Geometry::has_batched_sqdist<Tgeometry>::value );
+  Point a(0,0,0);
+  geo.randompos(a);
+  vector<Point> v(50);
+  vector<double> x, y, z, r2(v.size());
+  for (auto &b : v) {
+    geo.randompos(b);
+    x.push_back(b.x());
+    y.push_back(b.y());
+    z.push_back(b.z());
+  }
+  Geometry::sqdist(geo, a, x.data(), y.data(), z.data(), v.size(), r2.data());
+  for (size_t i=0; i<v.size(); i++) {
+    CHECK( r2[i] == Approx( geo.sqdist(a, v[i]) ) );
+    CHECK( geo.vdist(a, v[i]).squaredNorm() == Approx( r2[i] ) );
+    Point b = a + geo.vdist(v[i], a);
+    geo.boundary(b);
+    CHECK( geo.sqdist(b, v[i]) == Approx(0).epsilon(1e-8) );
+  }
+}
+
+TEST_CASE("Minimum image", "Periodic boundaries and batched distances")
+{
+  Geometry::Cuboid box;
+  box.setlen( Point(10,20,30) );
+  Geometry::Cuboidslit slit;
+  slit.setlen( Point(10,20,30) );
+  Geometry::PeriodicCylinder cyl(40,10);
+  checkMinimumImage(box);
+  checkMinimumImage(slit);
+  checkMinimumImage(cyl);
+  CHECK( !Geometry::has_batched_sqdist<Geometry::Sphere>::value );
+
+  Point a(4.9,-9.9,14.9), b(-4.9,9.9,-14.9);
+  CHECK( box.sqdist(a,b) == Approx(0.2*0.2*3) );
+  CHECK( box.vdist(a,b).x() == Approx(-0.2) );
+  CHECK( slit.vdist(a,b).z() == Approx(29.8) );
+  Point c(26,-12,0);
+  box.boundary(c);
+  CHECK( c.x() == Approx(-4) );
+  CHECK( c.y() == Approx(8) );
+}
+
 TEST_CASE("Random numbers", "Check random number generator")
 {
   int min=10, max=0, N=1e7;
@@ -276,6 +1431,39 @@ TEST_CASE("Random numbers", "Check random number generator")
   CHECK( std::fabs(x/N) == Approx(4.5).epsilon(0.05) );
 }
 
+TEST_CASE("Random streams", "Check counter-based generator and stream splitting")
+{
+  Philox4x32 a(0,0);
+  CHECK( a() == 0x6627e8d5 ); // known answer for zero key and counter
+  CHECK( a() == 0xe169c58d );
+  CHECK( a() == 0xbc57ac4c );
+  CHECK( a() == 0x9b00dbd8 );
+
+  Philox4x32 b(42,0), c(42,0), d(42,1);
+  for (int i=0; i<11; i++)
+    b();
+  c.discard(11);
+  CHECK( b == c );
+  CHECK( b() == c() );
+  CHECK( Philox4x32(42,0)() != d() );
+
+  std::stringstream s;
+  s << b;
+  s >> d;
+  CHECK( b() == d() );
+
+  RandomStreams<> ran(42, 3), ran2(42, 3);
+  CHECK( ran.size() == 3 );
+  CHECK( ran[1]() == Approx( ran2[1]() ) );
+  CHECK( ran[0]() != Approx( ran[2]() ) );
+
+  int N=1e6;
+  double x=0;
+  for (int i=0; i<N; i++)
+    x += ran()();
+  CHECK( x/N == Approx(0.5).epsilon(0.01) );
+}
+
 TEST_CASE("Quaternion", "Check vector rotation")
 {
   Geometry::QuaternionRotate qrot;
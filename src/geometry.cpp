@@ -485,8 +485,7 @@ namespace Faunus
 
     void PeriodicCylinder::boundary( Point &a ) const
     {
-        if ( std::abs(a.z()) > _halflen )
-            a.z() -= _len * anint(a.z() / _len);
+        a.z() -= _len * anint(a.z() / _len);
     }
 
     void QuaternionRotate::setAxis( Geometrybase &g, const Point &beg, const Point &end, double angle )